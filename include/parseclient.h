@@ -18,6 +18,7 @@
 #pragma once
 
 #include "parse.h"
+#include "parserequest.h"
 #include <QByteArray>
 
 class QNetworkAccessManager;
@@ -38,6 +39,42 @@ namespace cg
         QByteArray serverUrl() const;
         bool isLoggingEnabled() const;
         void setLoggingEnabled(bool enabled);
+        int batchSize() const;
+        void setBatchSize(int size);
+        int maxBatchesInFlight() const;
+        void setMaxBatchesInFlight(int count);
+        bool isCoalescingEnabled() const;
+        void setCoalescingEnabled(bool enabled);
+        int coalescingInterval() const;
+        void setCoalescingInterval(int msecs);
+        int queryCacheSize() const;
+        void setQueryCacheSize(int bytes);
+        bool isIdentityMapEnabled() const;
+        void setIdentityMapEnabled(bool enabled);
+        int decodeThreadThreshold() const;
+        void setDecodeThreadThreshold(int bytes);
+        bool isVectorizedDecodingEnabled() const;
+        void setVectorizedDecodingEnabled(bool enabled);
+        int maxRequestsPerHost() const;
+        void setMaxRequestsPerHost(int count);
+        int maxInteractiveRequestsPerHost() const;
+        void setMaxInteractiveRequestsPerHost(int count);
+        int maxNormalRequestsPerHost() const;
+        void setMaxNormalRequestsPerHost(int count);
+        int maxBulkRequestsPerHost() const;
+        void setMaxBulkRequestsPerHost(int count);
+        bool isAdaptiveConcurrencyEnabled() const;
+        void setAdaptiveConcurrencyEnabled(bool enabled);
+        int requestLimit() const;
+        int queuedRequestCount() const;
+        ParseRetryPolicy retryPolicy() const;
+        void setRetryPolicy(const ParseRetryPolicy &policy);
+        int retriedRequestCount() const;
+        int transferTimeout() const;
+        void setTransferTimeout(int msecs);
+        ParseHedgePolicy hedgePolicy() const;
+        void setHedgePolicy(const ParseHedgePolicy &policy);
+        int hedgedRequestCount() const;
 
     private:
         ParseClient();
@@ -47,6 +84,18 @@ namespace cg
         static QNetworkAccessManager *_pNetworkAccessManager;
         QByteArray _appId, _clientKey, _masterKey, _serverUrl;
         bool _loggingEnabled;
+        int _batchSize, _maxBatchesInFlight;
+        bool _coalescingEnabled;
+        int _coalescingInterval;
+        int _queryCacheSize;
+        bool _identityMapEnabled;
+        int _decodeThreadThreshold;
+        bool _vectorizedDecodingEnabled;
+        int _maxRequestsPerHost, _maxInteractiveRequestsPerHost, _maxNormalRequestsPerHost, _maxBulkRequestsPerHost;
+        bool _adaptiveConcurrencyEnabled;
+        ParseRetryPolicy _retryPolicy;
+        ParseHedgePolicy _hedgePolicy;
+        int _transferTimeout;
     };
 }
 
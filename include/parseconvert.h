@@ -20,6 +20,8 @@
 #include "parse.h"
 #include <QVariant>
 #include <QJsonObject>
+#include <QByteArray>
+#include <QList>
 
 namespace cg
 {
@@ -30,18 +32,35 @@ namespace cg
     {
     public:
         static QJsonObject toJsonObject(const QVariantMap &map);
+        static QByteArray toJson(const QVariantMap &map);
         static QVariantMap toVariantMap(const QJsonObject &object);
         static QVariantMap toVariantMap(const ParseObject& object);
         static ParseObject toObject(const QVariant &variant);
+        static ParseObject toObject(const QString &className, const QJsonObject &jsonObject);
+        static QList<ParseObject> toObjects(const QString &className, const QByteArray &data);
 
         static bool isPointer(const QVariant &variant);
         static bool isObject(const QVariant &variant);
 
     private:
+        friend class ParseJsonReader;
+        friend class ParseJsonWriter;
+        friend class ParseResultTable;
+        friend class ParseReply;
+
+        // the decoders take whether the identity map is used, so decoding on a worker thread never reads ParseClient
+        static ParseObject toObject(const QString &className, const QJsonObject &jsonObject, bool identityMapped);
+        static QList<ParseObject> toObjects(const QString &className, const QByteArray &data, bool identityMapped);
+
         static QVariantMap convertMap(const QVariantMap &map);
         static QVariantList convertList(const QVariantList &list);
         static bool canConvert(const QVariant &variant);
         static QVariant convertVariant(const QVariant &variant);
+        static ParseObject decodeObject(const QString &className, const QVariantMap &map, bool identityMapped);
+        static QVariantMap decodeMap(const QJsonObject &jsonObject, bool identityMapped);
+        static QVariant decodeValue(const QJsonValue &jsonValue, bool identityMapped);
+        static QVariant decodeJsonObject(const QJsonObject &jsonObject, bool identityMapped);
+        static QVariant decodeVariantMap(const QVariantMap &map, bool identityMapped);
 
         static QVariantMap convertMapToJson(const QVariantMap& map);
         static QVariantList convertListToJson(const QVariantList& list);
@@ -21,6 +21,7 @@ namespace cg
     {
         UnknownError = -1,
         OtherCause = -1,
+        RequestAborted = -2,
         NoError = 0,
         InternalServerError = 1,
         ServiceUnavailable = 2,
@@ -0,0 +1,183 @@
+/**
+* Copyright 2017 Charles Glancy (charles@glancyfamily.net)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+* files (the "Software"), to deal in the Software without restriction, including  without limitation the rights to use, copy,
+* modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+* is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+* WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#ifndef CGPARSE_PARSEFIELD_H
+#define CGPARSE_PARSEFIELD_H
+#pragma once
+
+#include "parse.h"
+#include "parseobject.h"
+#include "parsedatetime.h"
+#include "parsegeopoint.h"
+
+#include <QString>
+#include <QVariant>
+#include <QList>
+
+#include <array>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace cg
+{
+    // Converts a field between its C++ type and the value a ParseObject stores for it.
+    // Specialize it for types QVariant cannot convert on its own.
+    template <class T, class Enable = void>
+    struct ParseFieldType
+    {
+        static T decode(const QVariant &variant) { return variant.value<T>(); }
+        static QVariant encode(const T &value) { return QVariant::fromValue(value); }
+    };
+
+    // createdAt and updatedAt are plain strings, other dates are Date maps
+    template <>
+    struct ParseFieldType<QDateTime>
+    {
+        static QDateTime decode(const QVariant &variant)
+        {
+            return ParseDateTime::isDateTime(variant) ? ParseDateTime::toDateTime(variant) : variant.toDateTime();
+        }
+
+        static QVariant encode(const QDateTime &value) { return ParseDateTime(value); }
+    };
+
+    template <>
+    struct ParseFieldType<ParseGeoPoint>
+    {
+        static ParseGeoPoint decode(const QVariant &variant) { return ParseGeoPoint(variant); }
+        static QVariant encode(const ParseGeoPoint &value) { return static_cast<const QVariantMap &>(value); }
+    };
+
+    // pointers and nested objects, stored as ParseObject like setObject() does
+    template <class T>
+    struct ParseFieldType<T, std::enable_if_t<std::is_base_of_v<ParseObject, T>>>
+    {
+        static T decode(const QVariant &variant) { return T(variant.value<ParseObject>()); }
+        static QVariant encode(const T &value) { return QVariant::fromValue<ParseObject>(value); }
+    };
+
+    // One key of a record and the member that holds its value.
+    template <class Record, class T>
+    struct ParseField
+    {
+        using Type = T;
+
+        const char *key;
+        T Record::*member;
+    };
+
+    template <class Record, class T>
+    constexpr ParseField<Record, T> parseField(const char *key, T Record::*member)
+    {
+        return { key, member };
+    }
+
+    // Copies the values of a ParseObject into the native members of a plain struct and back,
+    // so code that reads the same fields of many objects pays for the key lookups and QVariant
+    // conversions once. The struct lists its fields and names its class:
+    //
+    //     struct Quote
+    //     {
+    //         QString objectId;
+    //         int rank = 0;
+    //         QString quote;
+    //
+    //         static constexpr const char *className = "TestQuote";
+    //         static constexpr auto fields = std::make_tuple(
+    //             cg::parseField("objectId", &Quote::objectId),
+    //             cg::parseField("rank", &Quote::rank),
+    //             cg::parseField("quote", &Quote::quote));
+    //     };
+    template <class Record>
+    class ParseRecord
+    {
+    public:
+        static constexpr std::size_t FieldCount = std::tuple_size_v<std::decay_t<decltype(Record::fields)>>;
+
+        static Record fromObject(const ParseObject &object)
+        {
+            Record record;
+            decode(object, record, std::make_index_sequence<FieldCount>());
+            return record;
+        }
+
+        static QList<Record> fromObjects(const QList<ParseObject> &objects)
+        {
+            QList<Record> records;
+            records.reserve(objects.size());
+
+            for (auto const &object : objects)
+                records.append(fromObject(object));
+
+            return records;
+        }
+
+        // writes every field into the object, a null object is created with the class of the record
+        static ParseObject toObject(const Record &record, ParseObject object = ParseObject())
+        {
+            if (object.isNull())
+                object = ParseObject(QString::fromLatin1(Record::className));
+
+            encode(record, object, std::make_index_sequence<FieldCount>());
+            return object;
+        }
+
+        // the keys are converted to QString once for each record type
+        static const std::array<QString, FieldCount> & keys()
+        {
+            static const std::array<QString, FieldCount> keys = makeKeys(std::make_index_sequence<FieldCount>());
+            return keys;
+        }
+
+    private:
+        template <std::size_t... I>
+        static std::array<QString, FieldCount> makeKeys(std::index_sequence<I...>)
+        {
+            return { { QString::fromLatin1(std::get<I>(Record::fields).key)... } };
+        }
+
+        template <std::size_t... I>
+        static void decode(const ParseObject &object, Record &record, std::index_sequence<I...>)
+        {
+            const auto &fieldKeys = keys();
+            (decodeField(object, record, std::get<I>(Record::fields), fieldKeys[I]), ...);
+        }
+
+        template <std::size_t... I>
+        static void encode(const Record &record, ParseObject &object, std::index_sequence<I...>)
+        {
+            const auto &fieldKeys = keys();
+            (encodeField(record, object, std::get<I>(Record::fields), fieldKeys[I]), ...);
+        }
+
+        // a missing key leaves the member at its default value
+        template <class Field>
+        static void decodeField(const ParseObject &object, Record &record, const Field &field, const QString &key)
+        {
+            QVariant variant = object.value(key);
+            if (variant.isValid())
+                record.*field.member = ParseFieldType<typename Field::Type>::decode(variant);
+        }
+
+        template <class Field>
+        static void encodeField(const Record &record, ParseObject &object, const Field &field, const QString &key)
+        {
+            object.setValue(key, ParseFieldType<typename Field::Type>::encode(record.*field.member));
+        }
+    };
+}
+
+#endif // CGPARSE_PARSEFIELD_H
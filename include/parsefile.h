@@ -66,6 +66,8 @@ namespace cg
         QVariantMap toMap() const;
         void setValues(const QVariantMap &map);
 
+        friend CGPARSE_API bool operator==(const ParseFile& file1, const ParseFile& file2);
+
     private:
         friend class ParseFileRequest;
         QSharedPointer<ParseFileImpl> _pImpl;
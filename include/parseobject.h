@@ -82,6 +82,7 @@ namespace cg
         bool hasSameId(const ParseObject& object) const;
         bool isDirty() const;
         bool isDirty(const QString &key) const;
+        QStringList dirtyKeys() const;
         void revert();
         void revert(const QString &key);
 
@@ -267,6 +268,12 @@ namespace cg
         }
 
     private:
+        friend class ParseConvert;
+        friend class ParseObjectRequest;
+        friend class ParseUserRequest;
+
+        void setServerValues(const QVariantMap &variantMap);
+
         QSharedPointer<ParseObjectImpl> _pImpl;
     };
 
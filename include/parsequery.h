@@ -27,6 +27,7 @@
 #include <QJsonDocument>
 #include <QJsonArray>
 #include <QMetaType>
+#include <functional>
 
 
 namespace cg
@@ -130,6 +131,42 @@ namespace cg
             return *this;
         }
 
+        ParseQuery<T>& setCachePolicy(ParseCachePolicy policy)
+        {
+            _pImpl->cachePolicy = policy;
+            return *this;
+        }
+
+        ParseCachePolicy cachePolicy() const
+        {
+            return _pImpl->cachePolicy;
+        }
+
+        // find() hands results to ParseReply::resultsAvailable() as they arrive instead of
+        // collecting them in results(), so large result sets are never held in memory at once
+        ParseQuery<T>& setStreamingEnabled(bool enabled)
+        {
+            _pImpl->streamingEnabled = enabled;
+            return *this;
+        }
+
+        bool isStreamingEnabled() const
+        {
+            return _pImpl->streamingEnabled;
+        }
+
+        // the lane the requests of this query wait in while the server is busy with others
+        ParseQuery<T>& setPriority(ParseRequest::Priority priority)
+        {
+            _pImpl->priority = priority;
+            return *this;
+        }
+
+        ParseRequest::Priority priority() const
+        {
+            return _pImpl->priority;
+        }
+
         ParseQuery<T>& selectKeys(const QStringList &keys)
         {
             _pImpl->keysList = keys;
@@ -399,6 +436,38 @@ namespace cg
             return ParseQueryRequest::get()->findObjects(_pImpl, urlQuery(), pNam);
         }
 
+        // pages through all matching objects ordered by cursorKey, which must be unique, instead of using skip;
+        // the reply emits resultsAvailable() for each page and finishes after the last one. Date keys work too,
+        // but objects with the same date as the last one of a page are skipped
+        ParseReply* stream(int pageSize = 100, const QString &cursorKey = Parse::ObjectIdKey, QNetworkAccessManager* pNam = nullptr)
+        {
+            return ParseQueryRequest::get()->streamObjects(_pImpl, cursorKey, pageSize, pNam);
+        }
+
+        ParseReply* each(const std::function<void(const QList<T>&)> &callback, int pageSize = 100,
+            const QString &cursorKey = Parse::ObjectIdKey, QNetworkAccessManager* pNam = nullptr)
+        {
+            return ParseQueryRequest::get()->streamObjects(_pImpl, cursorKey, pageSize, pNam, [callback](const QList<ParseObject> &objects)
+            {
+                QList<T> list;
+                list.reserve(objects.size());
+
+                for (auto const& object : objects)
+                    list.append(T(object));
+
+                callback(list);
+            });
+        }
+
+        // fetches all matching objects in partitionCount groups, by the first character of their objectId, that are
+        // paged concurrently, at most maxConcurrent at a time; pages arrive as they complete unless ordered, which
+        // emits them by objectId as long as the server sorts objectIds by character code
+        ParseReply* scan(int partitionCount = 8, int maxConcurrent = 4, bool ordered = false, int pageSize = 100,
+            QNetworkAccessManager* pNam = nullptr)
+        {
+            return ParseQueryRequest::get()->scanObjects(_pImpl, partitionCount, maxConcurrent, ordered, pageSize, pNam);
+        }
+
         T first()
         {
             if (_pImpl->results.size() > 0)
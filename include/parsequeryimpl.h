@@ -18,6 +18,7 @@
 #pragma once
 
 #include "parse.h"
+#include "parserequest.h"
 
 #include <QString>
 #include <QJsonObject>
@@ -26,6 +27,16 @@ namespace cg
 {
     class ParseObject;
 
+    // where ParseQuery results come from, see ParseQuery::setCachePolicy()
+    enum ParseCachePolicy
+    {
+        NetworkOnly,
+        CacheOnly,
+        CacheElseNetwork,
+        NetworkElseCache,
+        CacheThenNetwork
+    };
+
     class CGPARSE_API ParseQueryImpl
     {
     public:
@@ -39,6 +50,9 @@ namespace cg
         int limit, skip, count;
         QStringList keysList, orderList, includeList;
         int countResult;
+        ParseCachePolicy cachePolicy;
+        bool streamingEnabled;
+        ParseRequest::Priority priority;
         QList<ParseObject> results;
     };
 }
@@ -19,6 +19,8 @@
 
 #include <QObject>
 #include <QSharedPointer>
+#include <QCache>
+#include <functional>
 #include "parse.h"
 #include "parsequeryimpl.h"
 
@@ -28,6 +30,9 @@ class QUrlQuery;
 namespace cg
 {
 	class ParseReply;
+	class ParseObject;
+	class ParseQueryScan;
+	class ParseRequest;
 
 	class CGPARSE_API ParseQueryRequest : public QObject
 	{
@@ -38,6 +43,13 @@ namespace cg
 		ParseReply* getObject(QSharedPointer<ParseQueryImpl> pQueryImpl, const QString& objectId, QNetworkAccessManager* pNam);
 		ParseReply* findObjects(QSharedPointer<ParseQueryImpl> pQueryImpl, const QUrlQuery& urlQuery, QNetworkAccessManager* pNam);
 		ParseReply* countObjects(QSharedPointer<ParseQueryImpl> pQueryImpl, const QUrlQuery& urlQuery, QNetworkAccessManager* pNam);
+		ParseReply* streamObjects(QSharedPointer<ParseQueryImpl> pQueryImpl, const QString& cursorKey, int pageSize, QNetworkAccessManager* pNam,
+			const std::function<void(const QList<ParseObject>&)>& callback = nullptr);
+		ParseReply* scanObjects(QSharedPointer<ParseQueryImpl> pQueryImpl, int partitionCount, int maxConcurrent, bool ordered, int pageSize,
+			QNetworkAccessManager* pNam, const std::function<void(const QList<ParseObject>&)>& callback = nullptr);
+
+		void clearCache();
+		void clearCache(const QString& className);
 
 	private slots:
 		void getObjectFinished();
@@ -49,11 +61,17 @@ namespace cg
 		~ParseQueryRequest();
 
 		void setResults(QSharedPointer<ParseQueryImpl>, const QJsonArray& jsonArray);
+		ParseReply* sendQuery(QSharedPointer<ParseQueryImpl> pQueryImpl, const ParseRequest& request, QNetworkAccessManager* pNam,
+			void (ParseQueryRequest::*finishedSlot)());
+		void cachedResultsAvailable(ParseReply* pReply, QSharedPointer<ParseQueryImpl> pQueryImpl, const QByteArray& data);
+		static QString cacheKey(const ParseRequest& request);
+		ParseReply* startScan(ParseQueryScan* pScan, const QString& className, const std::function<void(const QList<ParseObject>&)>& callback);
 		static QString classPath(const QString& className);
 
 	private:
 		static ParseQueryRequest* _instance;
 		QMap<ParseReply*, QSharedPointer<ParseQueryImpl>> _replyMap;
+		QCache<QString, QByteArray> _cache;
 	};
 }
 
@@ -21,15 +21,18 @@
 #include "parseobject.h"
 #include "parseerror.h"
 #include "parseconvert.h"
+#include "parseresulttable.h"
 
 #include <QString>
 #include <QByteArray>
 #include <QSharedPointer>
+#include <QPointer>
+#include <QDeadlineTimer>
 #include <QJsonDocument>
 #include <QJsonArray>
 
-class QNetworkReply;
 class QNetworkAccessManager;
+class QTimer;
 
 namespace cg
 {
@@ -38,12 +41,15 @@ namespace cg
     class ParseSession;
     class ParseGraphQL;
     class ParseAnalytics;
+    class ParseNetworkRequest;
+    class ParseResultsTokenizer;
 
     class CGPARSE_API ParseReply : public QObject
     {
         Q_OBJECT
     public:
         ParseReply(int error = NoError);
+        explicit ParseReply(const QString& className);
         ParseReply(const ParseRequest& request, QNetworkAccessManager* pNam);
         ParseReply(const ParseRequest &request, const QString& className, QNetworkAccessManager* pNam);
         ParseReply(const ParseGraphQL& graphQL, QNetworkAccessManager* pNam = nullptr);
@@ -54,6 +60,11 @@ namespace cg
         void sendRequest(const ParseGraphQL& request, QNetworkAccessManager* pNam);
         void sendRequest(const ParseAnalytics& request, QNetworkAccessManager* pNam);
 
+        void abort();
+        bool isAborted() const;
+        QDeadlineTimer deadline() const;
+        void setDeadline(const QDeadlineTimer& deadline);
+
         QString className() const;
         bool isError() const;
         int statusCode() const;
@@ -62,6 +73,11 @@ namespace cg
 
         QByteArray data() const;
         const QByteArray & constData() const;
+        const QJsonDocument & document() const;
+        bool isDataRetained() const;
+        void setDataRetained(bool retained);
+        bool isStreamingEnabled() const;
+        void setStreamingEnabled(bool enabled);
 
         int count() const;
         ParseUser user() const;
@@ -71,29 +87,11 @@ namespace cg
         QList<T> objects() const
         {
             QList<T> list;
+            const QList<ParseObject> &objects = resultObjects();
+            list.reserve(objects.size());
 
-            QJsonDocument doc = QJsonDocument::fromJson(constData());
-            if (doc.isObject())
-            {
-                QJsonObject obj = doc.object();
-                QJsonArray jsonArray = obj.value("results").toArray();
-
-                for (auto jsonValue : jsonArray)
-                {
-                    if (jsonValue.isObject())
-                    {
-                        QJsonObject jsonObject = jsonValue.toObject();
-                        QString objectId = jsonObject.value(Parse::ObjectIdKey).toString();
-                        if (!objectId.isEmpty())
-                        {
-                            ParseObject object = ParseObject(_className);
-                            object.setValues(ParseConvert::toVariantMap(jsonObject));
-                            object.clearDirtyState();
-                            list.append(T(object));
-                        }
-                    }
-                }
-            }
+            for (auto const& object : objects)
+                list.append(T(object));
 
             return list;
         }
@@ -109,27 +107,46 @@ namespace cg
             return T();
         }
 
+        ParseResultTable table(const QStringList& keys = QStringList()) const;
         QVariantMap graphQLResult() const;
 
     signals:
+        void aborted();
         void preFinished();
         void finished();
-
-    private slots:
-        void replyFinished();
+        void progress(int completed, int total);
+        void resultsAvailable(const QList<cg::ParseObject>& objects);
 
     private:
-        static int statusCode(QNetworkReply *pReply);
-        static int errorCode(const QByteArray &data);
-        static QString errorMessage(const QByteArray &data);
+        friend class ParseObjectRequest;
+        friend class ParseQueryRequest;
+
+        void setNetworkRequest(ParseNetworkRequest* pNetworkRequest);
+        struct DecodedReply;
+
+        void streamData(const QByteArray& data);
+        void decode(int status, const QByteArray &data);
+        void finish(int status, const QByteArray &data, const DecodedReply* pDecoded = nullptr);
+        void finish(const ParseReply* pSource);
+        void cancel(int error, const QString& message);
+        void fail(int status, int error, const QString& message);
+        const QList<ParseObject> & resultObjects() const;
+        static QList<ParseObject> decodeResults(const QString& className, const QJsonDocument& document, bool identityMapped);
         static bool isError(int status);
 
     private:
-        QNetworkReply *_pReply;
+        QPointer<ParseNetworkRequest> _pNetworkRequest;
         QString _className;
         int _statusCode, _errorCode;
         QString _errorMessage;
-        QByteArray _data;
+        mutable QByteArray _data;
+        mutable QJsonDocument _document;
+        mutable QList<ParseObject> _objects;
+        mutable bool _documentParsed, _objectsDecoded;
+        bool _dataRetained, _streamingEnabled, _aborted;
+        QDeadlineTimer _deadline;
+        QTimer* _pDeadlineTimer;
+        QSharedPointer<ParseResultsTokenizer> _pTokenizer;
     };
 
 }
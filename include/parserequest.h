@@ -21,12 +21,36 @@
 #include <QByteArray>
 #include <QUrlQuery>
 #include <QNetworkRequest>
+#include <QList>
 
 class QNetworkReply;
 class QNetworkAccessManager;
 
 namespace cg
 {
+    // How a request is sent again after a transient failure. The delay before each retry is
+    // a random time up to initialDelay doubled for every earlier retry, capped at maxDelay,
+    // so clients that failed together do not all retry at the same moment.
+    struct ParseRetryPolicy
+    {
+        int maxAttempts = 1;
+        int initialDelay = 100;
+        int maxDelay = 10000;
+        QList<int> retryableStatusCodes = { 408, 429, 500, 502, 503, 504 };
+        bool retryNetworkErrors = true;
+    };
+
+    // How a slow GET is sent a second time. When no response has arrived after the given
+    // percentile of recent round trips to the server, a duplicate is sent and whichever
+    // answers first is used. Each request earns budgetPercent / 100 of a hedge, so at most
+    // that share of requests is sent twice.
+    struct ParseHedgePolicy
+    {
+        bool enabled = false;
+        double percentile = 95;
+        int budgetPercent = 5;
+    };
+
     class ParseRequest
     {
     public:
@@ -39,6 +63,14 @@ namespace cg
             DeleteHttpMethod
         };
 
+        // the lane a request waits in until the server has a free slot for it
+        enum Priority
+        {
+            InteractivePriority,
+            NormalPriority,
+            BulkPriority
+        };
+
         static const QString JsonContentType;
         static QByteArray userAgent();
 
@@ -69,6 +101,18 @@ namespace cg
         QByteArray content() const;
         void setContent(const QByteArray& content);
 
+        Priority priority() const;
+        void setPriority(Priority priority);
+
+        ParseRetryPolicy retryPolicy() const;
+        void setRetryPolicy(const ParseRetryPolicy &policy);
+
+        int transferTimeout() const;
+        void setTransferTimeout(int msecs);
+
+        ParseHedgePolicy hedgePolicy() const;
+        void setHedgePolicy(const ParseHedgePolicy &policy);
+
         QByteArray header(const QByteArray &header) const;
         void setHeader(const QByteArray &header, const QByteArray &value);
         void removeHeader(const QByteArray &header);
@@ -76,6 +120,8 @@ namespace cg
         QNetworkReply * sendRequest(QNetworkAccessManager *pNam) const;
 
     private:
+        friend class ParseNetworkRequest;
+
         void init();
         void logRequest() const;
         QString fullUrl() const;
@@ -83,10 +129,14 @@ namespace cg
 
     private:
         HttpMethod _method;
+        Priority _priority;
         QString _apiRoute, _contentType;
         QByteArray _content;
         QUrlQuery _urlQuery;
         QMap<QByteArray, QByteArray> _headers;
+        ParseRetryPolicy _retryPolicy;
+        ParseHedgePolicy _hedgePolicy;
+        int _transferTimeout;
     };
 }
 
@@ -0,0 +1,91 @@
+/**
+* Copyright 2017 Charles Glancy (charles@glancyfamily.net)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+* files (the "Software"), to deal in the Software without restriction, including  without limitation the rights to use, copy,
+* modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+* is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+* WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#ifndef CGPARSE_PARSERESULTTABLE_H
+#define CGPARSE_PARSERESULTTABLE_H
+#pragma once
+
+#include "parse.h"
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QBitArray>
+#include <QHash>
+#include <QVariant>
+#include <QJsonArray>
+#include <QJsonValue>
+
+namespace cg
+{
+    // Query results stored by column, each key of the results in one contiguous typed list
+    // with a null bitmap. Null rows hold a default value so rows line up across columns,
+    // and the lists are implicitly shared so exporting a column does not copy it.
+    class CGPARSE_API ParseResultTable
+    {
+    public:
+        enum ColumnType
+        {
+            NullColumn,         // no row has a value
+            DoubleColumn,       // doubles()
+            IntegerColumn,      // integers()
+            BoolColumn,         // integers(), 0 or 1
+            StringColumn,       // strings()
+            DateColumn,         // integers(), milliseconds since the epoch
+            PointerColumn,      // strings(), the objectId of each pointer
+            GeoPointColumn,     // doubles(), latitude and longitude pairs
+            VariantColumn       // variants(), mixed or nested values
+        };
+
+    public:
+        ParseResultTable();
+        ParseResultTable(const QJsonArray &results, const QStringList &keys = QStringList());
+
+        bool isEmpty() const;
+        int rowCount() const;
+        QStringList keys() const;
+        bool contains(const QString &key) const;
+
+        ColumnType columnType(const QString &key) const;
+        bool isNull(const QString &key, int row) const;
+        QBitArray nulls(const QString &key) const;
+
+        QList<double> doubles(const QString &key) const;
+        QList<qint64> integers(const QString &key) const;
+        QStringList strings(const QString &key) const;
+        QVariantList variants(const QString &key) const;
+
+    private:
+        struct Column
+        {
+            ColumnType type = NullColumn;
+            QBitArray nulls;
+            QList<double> doubles;
+            QList<qint64> integers;
+            QStringList strings;
+            QVariantList variants;
+        };
+
+        static ColumnType valueType(const QString &key, const QJsonValue &value);
+        static ColumnType mergeTypes(ColumnType type1, ColumnType type2);
+        static Column decodeColumn(const QJsonArray &results, const QString &key);
+
+    private:
+        int _rowCount;
+        QStringList _keys;
+        QHash<QString, Column> _columns;
+    };
+}
+
+#endif // CGPARSE_PARSERESULTTABLE_H
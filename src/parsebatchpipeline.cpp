@@ -0,0 +1,155 @@
+/**
+* Copyright 2017 Charles Glancy (charles@glancyfamily.net)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+* files (the "Software"), to deal in the Software without restriction, including  without limitation the rights to use, copy,
+* modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+* is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+* WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "parsebatchpipeline.h"
+#include "parseclient.h"
+#include "parsereply.h"
+#include "parseerror.h"
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+
+namespace cg
+{
+    ParseBatchPipeline::ParseBatchPipeline(int size, const SendChunk& sendChunk, QObject* parent)
+        : QObject(parent)
+        , _sendChunk(sendChunk)
+        , _size(size)
+        , _chunkSize(ParseClient::get()->batchSize())
+        , _maxChunksInFlight(ParseClient::get()->maxBatchesInFlight())
+        , _nextIndex(0)
+        , _completed(0)
+        , _chunks(0)
+        , _failedChunks(0)
+        , _errorStatus(0)
+    {
+        _results.resize(size);
+    }
+
+    ParseBatchPipeline::~ParseBatchPipeline()
+    {
+    }
+
+    void ParseBatchPipeline::start()
+    {
+        sendNextChunks();
+    }
+
+    // aborts the batches in flight and sends no more, finished() is not emitted
+    void ParseBatchPipeline::abort()
+    {
+        _nextIndex = _size;
+
+        QList<ParseReply*> replies = _chunkStartMap.keys();
+        _chunkStartMap.clear();
+
+        for (auto pReply : replies)
+        {
+            disconnect(pReply, nullptr, this, nullptr);
+            pReply->abort();
+            pReply->deleteLater();
+        }
+
+        deleteLater();
+    }
+
+    void ParseBatchPipeline::sendNextChunks()
+    {
+        while (_nextIndex < _size && _chunkStartMap.size() < _maxChunksInFlight)
+        {
+            int from = _nextIndex;
+            int count = qMin(_chunkSize, _size - from);
+            _nextIndex += count;
+            _chunks++;
+
+            ParseReply *pReply = _sendChunk(from, count);
+            connect(pReply, &ParseReply::finished, this, &ParseBatchPipeline::chunkFinished);
+            _chunkStartMap.insert(pReply, from);
+        }
+
+        if (_chunkStartMap.isEmpty())
+        {
+            if (_chunks > 0 && _failedChunks == _chunks)
+            {
+                // nothing was sent successfully, report the error like a single /batch request would
+                emit finished(_errorStatus, _errorData);
+            }
+            else
+            {
+                QJsonArray resultsArray;
+                for (auto & result : _results)
+                    resultsArray.append(result);
+
+                emit finished(200, QJsonDocument(resultsArray).toJson(QJsonDocument::Compact));
+            }
+        }
+    }
+
+    void ParseBatchPipeline::chunkFinished()
+    {
+        ParseReply *pReply = qobject_cast<ParseReply*>(sender());
+        if (!pReply || !_chunkStartMap.contains(pReply))
+            return;
+
+        int from = _chunkStartMap.take(pReply);
+        int count = qMin(_chunkSize, _size - from);
+
+        QJsonDocument doc;
+        if (!pReply->isError())
+            doc = pReply->document();
+
+        if (doc.isArray())
+        {
+            QJsonArray resultsArray = doc.array();
+            for (int i = 0; i < count && i < resultsArray.size(); i++)
+                _results[from + i] = resultsArray.at(i);
+        }
+        else
+        {
+            setChunkError(from, count, pReply);
+        }
+
+        _completed += count;
+        emit progress(_completed, _size);
+
+        pReply->deleteLater();
+        sendNextChunks();
+    }
+
+    // a /batch request that failed as a whole gives each of its operations the request's error
+    void ParseBatchPipeline::setChunkError(int from, int count, ParseReply* pReply)
+    {
+        if (_failedChunks == 0)
+        {
+            _errorStatus = pReply->statusCode();
+            _errorData = pReply->data();
+        }
+
+        _failedChunks++;
+
+        int code = pReply->errorCode() != ParseError::NoError ? pReply->errorCode() : ParseError::UnknownError;
+
+        QJsonObject errorObject;
+        errorObject.insert("code", code);
+        errorObject.insert("error", pReply->errorMessage());
+
+        QJsonObject resultObject;
+        resultObject.insert("error", errorObject);
+
+        for (int i = 0; i < count; i++)
+            _results[from + i] = resultObject;
+    }
+}
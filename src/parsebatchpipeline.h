@@ -0,0 +1,70 @@
+/**
+* Copyright 2017 Charles Glancy (charles@glancyfamily.net)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+* files (the "Software"), to deal in the Software without restriction, including  without limitation the rights to use, copy,
+* modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+* is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+* WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#ifndef CGPARSE_PARSEBATCHPIPELINE_H
+#define CGPARSE_PARSEBATCHPIPELINE_H
+#pragma once
+
+#include "parse.h"
+
+#include <QObject>
+#include <QList>
+#include <QMap>
+#include <QJsonValue>
+#include <functional>
+
+namespace cg
+{
+    class ParseReply;
+
+    // Sends a long list of batch operations as a series of /batch requests of at most
+    // ParseClient::batchSize() operations, keeping ParseClient::maxBatchesInFlight()
+    // of them in flight, and merges their results into a single results array.
+    class ParseBatchPipeline : public QObject
+    {
+        Q_OBJECT
+    public:
+        // sends the operations [from, from + count) and returns the reply of the /batch request
+        using SendChunk = std::function<ParseReply*(int from, int count)>;
+
+        ParseBatchPipeline(int size, const SendChunk& sendChunk, QObject* parent = nullptr);
+        ~ParseBatchPipeline();
+
+        void start();
+        void abort();
+
+    signals:
+        void progress(int completed, int total);
+        void finished(int status, const QByteArray& data);
+
+    private slots:
+        void chunkFinished();
+
+    private:
+        void sendNextChunks();
+        void setChunkError(int from, int count, ParseReply* pReply);
+
+    private:
+        SendChunk _sendChunk;
+        int _size, _chunkSize, _maxChunksInFlight;
+        int _nextIndex, _completed, _chunks, _failedChunks;
+        int _errorStatus;
+        QByteArray _errorData;
+        QMap<ParseReply*, int> _chunkStartMap;
+        QList<QJsonValue> _results;
+    };
+}
+
+#endif // CGPARSE_PARSEBATCHPIPELINE_H
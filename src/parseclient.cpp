@@ -15,8 +15,10 @@
 */
 #include "parseclient.h"
 #include "parseobject.h"
+#include "parsenetworkrequest.h"
 
 #include <QNetworkAccessManager>
+#include <QUrl>
 
 namespace cg {
     ParseClient * ParseClient::_pInstance = nullptr;
@@ -24,6 +26,20 @@ namespace cg {
 
     ParseClient::ParseClient()
         : _loggingEnabled(false)
+        , _batchSize(50)
+        , _maxBatchesInFlight(4)
+        , _coalescingEnabled(false)
+        , _coalescingInterval(0)
+        , _queryCacheSize(4 * 1024 * 1024)
+        , _identityMapEnabled(false)
+        , _decodeThreadThreshold(256 * 1024)
+        , _vectorizedDecodingEnabled(false)
+        , _maxRequestsPerHost(6)
+        , _maxInteractiveRequestsPerHost(0)
+        , _maxNormalRequestsPerHost(0)
+        , _maxBulkRequestsPerHost(4)
+        , _adaptiveConcurrencyEnabled(false)
+        , _transferTimeout(0)
     {
         qRegisterMetaType<ParseObject>();
     }
@@ -85,4 +101,206 @@ namespace cg {
     {
         _loggingEnabled = enabled;
     }
+
+    int ParseClient::batchSize() const
+    {
+        return _batchSize;
+    }
+
+    // maximum number of requests sent in a single /batch call
+    void ParseClient::setBatchSize(int size)
+    {
+        _batchSize = qMax(1, size);
+    }
+
+    int ParseClient::maxBatchesInFlight() const
+    {
+        return _maxBatchesInFlight;
+    }
+
+    // number of /batch requests that saveAll() and deleteAll() keep in flight for long lists
+    void ParseClient::setMaxBatchesInFlight(int count)
+    {
+        _maxBatchesInFlight = qMax(1, count);
+    }
+
+    bool ParseClient::isCoalescingEnabled() const
+    {
+        return _coalescingEnabled;
+    }
+
+    // when enabled, single object creates, updates and deletes are queued and sent together through /batch
+    void ParseClient::setCoalescingEnabled(bool enabled)
+    {
+        _coalescingEnabled = enabled;
+    }
+
+    int ParseClient::coalescingInterval() const
+    {
+        return _coalescingInterval;
+    }
+
+    // how long queued operations wait before being sent, 0 sends them at the end of the current event loop iteration
+    void ParseClient::setCoalescingInterval(int msecs)
+    {
+        _coalescingInterval = qMax(0, msecs);
+    }
+
+    int ParseClient::queryCacheSize() const
+    {
+        return _queryCacheSize;
+    }
+
+    // number of bytes of query results kept for the ParseQuery cache policies
+    void ParseClient::setQueryCacheSize(int bytes)
+    {
+        _queryCacheSize = qMax(0, bytes);
+    }
+
+    bool ParseClient::isIdentityMapEnabled() const
+    {
+        return _identityMapEnabled;
+    }
+
+    // when enabled, objects decoded from server responses share one instance per className and objectId
+    void ParseClient::setIdentityMapEnabled(bool enabled)
+    {
+        _identityMapEnabled = enabled;
+    }
+
+    int ParseClient::decodeThreadThreshold() const
+    {
+        return _decodeThreadThreshold;
+    }
+
+    // replies of at least this many bytes are decoded on the global QThreadPool, a negative value keeps all decoding on the thread that owns the reply
+    void ParseClient::setDecodeThreadThreshold(int bytes)
+    {
+        _decodeThreadThreshold = bytes;
+    }
+
+    bool ParseClient::isVectorizedDecodingEnabled() const
+    {
+        return _vectorizedDecodingEnabled;
+    }
+
+    // when enabled, query results are decoded straight from the reply data with ParseConvert::toObjects()
+    void ParseClient::setVectorizedDecodingEnabled(bool enabled)
+    {
+        _vectorizedDecodingEnabled = enabled;
+    }
+
+    int ParseClient::maxRequestsPerHost() const
+    {
+        return _maxRequestsPerHost;
+    }
+
+    // requests to one server beyond this many wait in their priority lane, 0 sends every request right away
+    void ParseClient::setMaxRequestsPerHost(int count)
+    {
+        _maxRequestsPerHost = count;
+    }
+
+    int ParseClient::maxInteractiveRequestsPerHost() const
+    {
+        return _maxInteractiveRequestsPerHost;
+    }
+
+    // interactive requests to one server beyond this many wait even when the server has free slots, 0 for no separate limit
+    void ParseClient::setMaxInteractiveRequestsPerHost(int count)
+    {
+        _maxInteractiveRequestsPerHost = count;
+    }
+
+    int ParseClient::maxNormalRequestsPerHost() const
+    {
+        return _maxNormalRequestsPerHost;
+    }
+
+    // keeps slots free for interactive requests while normal requests are waiting, 0 for no separate limit
+    void ParseClient::setMaxNormalRequestsPerHost(int count)
+    {
+        _maxNormalRequestsPerHost = count;
+    }
+
+    int ParseClient::maxBulkRequestsPerHost() const
+    {
+        return _maxBulkRequestsPerHost;
+    }
+
+    // keeps slots free for interactive and normal requests while bulk requests are waiting, 0 for no separate limit
+    void ParseClient::setMaxBulkRequestsPerHost(int count)
+    {
+        _maxBulkRequestsPerHost = count;
+    }
+
+    bool ParseClient::isAdaptiveConcurrencyEnabled() const
+    {
+        return _adaptiveConcurrencyEnabled;
+    }
+
+    // when enabled, the limit of requests in flight to each server starts at maxRequestsPerHost() and is raised
+    // while replies come back quickly, and lowered on 429 and 503 responses or when round trips grow
+    void ParseClient::setAdaptiveConcurrencyEnabled(bool enabled)
+    {
+        _adaptiveConcurrencyEnabled = enabled;
+    }
+
+    // the number of requests that may be in flight to the server right now, 0 for no limit
+    int ParseClient::requestLimit() const
+    {
+        return ParseNetworkRequest::requestLimit(QUrl(QString::fromUtf8(_serverUrl)));
+    }
+
+    // the number of requests waiting for a free slot on the server
+    int ParseClient::queuedRequestCount() const
+    {
+        return ParseNetworkRequest::queuedRequestCount(QUrl(QString::fromUtf8(_serverUrl)));
+    }
+
+    ParseRetryPolicy ParseClient::retryPolicy() const
+    {
+        return _retryPolicy;
+    }
+
+    // the policy new requests start with, POST and PUT requests that can be retried carry an
+    // X-Parse-Request-Id header so a server with idempotency enabled only applies them once
+    void ParseClient::setRetryPolicy(const ParseRetryPolicy &policy)
+    {
+        _retryPolicy = policy;
+    }
+
+    // the number of times a request has been sent again after a transient failure
+    int ParseClient::retriedRequestCount() const
+    {
+        return ParseNetworkRequest::retriedRequestCount();
+    }
+
+    int ParseClient::transferTimeout() const
+    {
+        return _transferTimeout;
+    }
+
+    // the transfer timeout new requests start with, 0 for none
+    void ParseClient::setTransferTimeout(int msecs)
+    {
+        _transferTimeout = msecs;
+    }
+
+    ParseHedgePolicy ParseClient::hedgePolicy() const
+    {
+        return _hedgePolicy;
+    }
+
+    // the policy new requests start with, hedging is off unless enabled here
+    void ParseClient::setHedgePolicy(const ParseHedgePolicy &policy)
+    {
+        _hedgePolicy = policy;
+    }
+
+    // the number of duplicate GET requests sent so far
+    int ParseClient::hedgedRequestCount() const
+    {
+        return ParseNetworkRequest::hedgedRequestCount();
+    }
 }
@@ -1,6 +1,12 @@
 #include "parseconvert.h"
 #include "parseobject.h"
 #include "parsefile.h"
+#include "parseobjectimpl.h"
+#include "parseclient.h"
+#include "parsejsonreader.h"
+#include "parsejsonwriter.h"
+
+#include <QJsonArray>
 
 namespace cg
 {
@@ -9,9 +15,17 @@ namespace cg
         return QJsonObject::fromVariantMap(convertMapToJson(map));
     }
 
+    // the compact JSON of toJsonObject(), written in one pass without the QJsonObject
+    QByteArray ParseConvert::toJson(const QVariantMap &map)
+    {
+        ParseJsonWriter writer;
+        writer.writeMap(map);
+        return writer.data();
+    }
+
     QVariantMap ParseConvert::toVariantMap(const QJsonObject &object)
     {
-        return convertMap(object.toVariantMap());
+        return decodeMap(object, ParseClient::get()->isIdentityMapEnabled());
     }
 
     QVariantMap ParseConvert::toVariantMap(const ParseObject& object)
@@ -158,21 +172,164 @@ namespace cg
             if (map.contains(Parse::TypeKey) && map.value(Parse::TypeKey).toString() == Parse::PointerValue)
             {
                 QString className = map.value(Parse::ClassNameKey).toString();
-                QString objectId = map.value(Parse::ObjectIdKey).toString();
-                object = ParseObject::createWithoutData(className, objectId);
+                QVariantMap pointerMap;
+                pointerMap.insert(Parse::ObjectIdKey, map.value(Parse::ObjectIdKey));
+                object = decodeObject(className, pointerMap, ParseClient::get()->isIdentityMapEnabled());
             }
             else if (map.contains(Parse::TypeKey) && map.value(Parse::TypeKey).toString() == Parse::ObjectValue)
             {
                 QString className = map.value(Parse::ClassNameKey).toString();
-                object = ParseObject::create(className);
-                object.setValues(map);
-                object.clearDirtyState();
+                object = decodeObject(className, map, ParseClient::get()->isIdentityMapEnabled());
             }
         }
 
         return object;
     }
 
+    ParseObject ParseConvert::toObject(const QString &className, const QJsonObject &jsonObject)
+    {
+        return toObject(className, jsonObject, ParseClient::get()->isIdentityMapEnabled());
+    }
+
+    ParseObject ParseConvert::toObject(const QString &className, const QJsonObject &jsonObject, bool identityMapped)
+    {
+        return decodeObject(className, decodeMap(jsonObject, identityMapped), identityMapped);
+    }
+
+    QList<ParseObject> ParseConvert::toObjects(const QString &className, const QByteArray &data)
+    {
+        return toObjects(className, data, ParseClient::get()->isIdentityMapEnabled());
+    }
+
+    // decodes the results of a query response straight from its bytes, without a QJsonDocument
+    QList<ParseObject> ParseConvert::toObjects(const QString &className, const QByteArray &data, bool identityMapped)
+    {
+        QList<ParseObject> objects;
+
+        ParseJsonReader reader(data, identityMapped);
+        QVariantList results = reader.read().toMap().value("results").toList();
+        objects.reserve(results.size());
+
+        for (auto const& result : results)
+        {
+            QVariantMap map = result.toMap();
+            if (!map.value(Parse::ObjectIdKey).toString().isEmpty())
+                objects.append(decodeObject(className, map, identityMapped));
+        }
+
+        return objects;
+    }
+
+    // decodes server JSON in one pass, giving the same values as QJsonObject::toVariantMap()
+    // followed by convertMap() without copying the maps again
+    QVariantMap ParseConvert::decodeMap(const QJsonObject &jsonObject, bool identityMapped)
+    {
+        QVariantMap map;
+
+        // QJsonObject keys are sorted so every insert goes at the end
+        for (auto it = jsonObject.constBegin(); it != jsonObject.constEnd(); ++it)
+            map.insert(map.constEnd(), it.key(), decodeValue(it.value(), identityMapped));
+
+        return map;
+    }
+
+    QVariant ParseConvert::decodeValue(const QJsonValue &jsonValue, bool identityMapped)
+    {
+        if (jsonValue.isObject())
+            return decodeJsonObject(jsonValue.toObject(), identityMapped);
+
+        if (jsonValue.isArray())
+        {
+            QJsonArray jsonArray = jsonValue.toArray();
+            QVariantList list;
+            list.reserve(jsonArray.size());
+
+            for (auto value : jsonArray)
+                list.append(decodeValue(value, identityMapped));
+
+            return list;
+        }
+
+        return jsonValue.toVariant();
+    }
+
+    QVariant ParseConvert::decodeJsonObject(const QJsonObject &jsonObject, bool identityMapped)
+    {
+        auto typeIt = jsonObject.constFind(Parse::TypeKey);
+        if (typeIt != jsonObject.constEnd())
+        {
+            QString type = typeIt.value().toString();
+
+            if (type == Parse::PointerValue)
+            {
+                QVariantMap pointerMap;
+                pointerMap.insert(Parse::ObjectIdKey, jsonObject.value(Parse::ObjectIdKey).toVariant());
+                return QVariant::fromValue(decodeObject(jsonObject.value(Parse::ClassNameKey).toString(), pointerMap, identityMapped));
+            }
+            else if (type == Parse::ObjectValue)
+            {
+                return QVariant::fromValue(toObject(jsonObject.value(Parse::ClassNameKey).toString(), jsonObject, identityMapped));
+            }
+            else if (type == Parse::FileValue)
+            {
+                ParseFile file;
+                if (jsonObject.contains("name") && jsonObject.contains("url"))
+                    file = ParseFile(jsonObject.value("name").toString(), jsonObject.value("url").toString());
+
+                return QVariant::fromValue(file);
+            }
+        }
+
+        return decodeMap(jsonObject, identityMapped);
+    }
+
+    // the ParseJsonReader counterpart of decodeJsonObject(), the map's values are already decoded
+    QVariant ParseConvert::decodeVariantMap(const QVariantMap &map, bool identityMapped)
+    {
+        auto typeIt = map.constFind(Parse::TypeKey);
+        if (typeIt != map.constEnd())
+        {
+            QString type = typeIt.value().toString();
+
+            if (type == Parse::PointerValue)
+            {
+                QVariantMap pointerMap;
+                pointerMap.insert(Parse::ObjectIdKey, map.value(Parse::ObjectIdKey));
+                return QVariant::fromValue(decodeObject(map.value(Parse::ClassNameKey).toString(), pointerMap, identityMapped));
+            }
+            else if (type == Parse::ObjectValue)
+            {
+                return QVariant::fromValue(decodeObject(map.value(Parse::ClassNameKey).toString(), map, identityMapped));
+            }
+            else if (type == Parse::FileValue)
+            {
+                ParseFile file;
+                if (map.contains("name") && map.contains("url"))
+                    file = ParseFile(map.value("name").toString(), map.value("url").toString());
+
+                return QVariant::fromValue(file);
+            }
+        }
+
+        return map;
+    }
+
+    // objects received from the server start clean, with the identity map enabled
+    // every copy of an objectId shares one instance that the new values are merged into
+    ParseObject ParseConvert::decodeObject(const QString &className, const QVariantMap &map, bool identityMapped)
+    {
+        ParseObject object;
+
+        QString objectId = map.value(Parse::ObjectIdKey).toString();
+        if (identityMapped && !objectId.isEmpty())
+            object._pImpl = ParseObjectImpl::identity(className, objectId);
+        else
+            object._pImpl = QSharedPointer<ParseObjectImpl>::create(className);
+
+        object._pImpl->mergeValues(map);
+        return object;
+    }
+
     bool ParseConvert::isPointer(const QVariant &variant)
     {
         bool pointer = false;
@@ -178,4 +178,9 @@ namespace cg
     {
         return ParseFileRequest::get()->fetchFile(*this, pNam);
     }
+
+    CGPARSE_API bool operator==(const ParseFile& file1, const ParseFile& file2)
+    {
+        return file1._pImpl == file2._pImpl;
+    }
 }
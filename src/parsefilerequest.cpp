@@ -57,7 +57,7 @@ namespace cg
 
 		if (!pReply->isError() && pReply->statusCode() == 201)
 		{
-			QJsonDocument doc = QJsonDocument::fromJson(pReply->data());
+			const QJsonDocument &doc = pReply->document();
 			if (doc.isObject())
 			{
 				QJsonObject obj = doc.object();
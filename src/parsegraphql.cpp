@@ -17,9 +17,8 @@
 #include "parseclient.h"
 #include "parsereply.h"
 #include "parserequest.h"
+#include "parsejsonwriter.h"
 
-#include <QJsonDocument>
-#include <QJsonObject>
 #include <QDebug>
 
 namespace cg
@@ -40,21 +39,28 @@ namespace cg
         setHeader("X-Parse-Master-Key", ParseClient::get()->masterKey());
         setHeader("X-Parse-Client-Key", ParseClient::get()->clientKey());
 
-        QJsonObject jsonObject;
-        jsonObject["query"] = queryStr;
+        // variables are plain JSON, they are not converted like Parse object values
+        ParseJsonWriter writer(queryStr.size() + 64, false);
+        writer.append('{');
 
         if (!operationStr.isEmpty())
-            jsonObject["operationName"] = operationStr;
+        {
+            writer.append("\"operationName\":");
+            writer.writeString(operationStr);
+            writer.append(',');
+        }
+
+        writer.append("\"query\":");
+        writer.writeString(queryStr);
 
         if (!variableMap.isEmpty())
         {
-            QJsonObject variableObject = QJsonObject::fromVariantMap(variableMap);
-            jsonObject["variables"] = variableObject;
+            writer.append(",\"variables\":");
+            writer.writeMap(variableMap);
         }
 
-        QJsonDocument doc;
-        doc.setObject(jsonObject);
+        writer.append('}');
 
-        setContent(doc.toJson());
+        setContent(writer.data());
     }
 }
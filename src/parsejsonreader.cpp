@@ -0,0 +1,387 @@
+/**
+* Copyright 2017 Charles Glancy (charles@glancyfamily.net)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+* files (the "Software"), to deal in the Software without restriction, including  without limitation the rights to use, copy,
+* modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+* is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+* WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "parsejsonreader.h"
+#include "parseconvert.h"
+
+#include <QVariantMap>
+#include <QVariantList>
+#include <QtAlgorithms>
+
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CGPARSE_JSON_SSE2
+#endif
+
+namespace cg
+{
+    // same nesting limit as QJsonDocument
+    static const int MaxDepth = 1024;
+
+    // longer strings are rarely repeated, pooling them would only grow the table
+    static const int MaxPooledSize = 32;
+
+    // identityMapped is whether decoded objects go through the identity map, it is passed in
+    // rather than read from ParseClient so a reader can run on a worker thread
+    ParseJsonReader::ParseJsonReader(const QByteArray& data, bool identityMapped)
+        : _p(data.constData())
+        , _end(data.constData() + data.size())
+        , _depth(0)
+        , _identityMapped(identityMapped)
+        , _error(false)
+    {
+    }
+
+    // reads the whole document, the data passed to the constructor must outlive the reader
+    QVariant ParseJsonReader::read()
+    {
+        skipWhitespace();
+        QVariant value = readValue();
+        skipWhitespace();
+
+        if (_error || _p != _end)
+            return fail();
+
+        return value;
+    }
+
+    bool ParseJsonReader::hasError() const
+    {
+        return _error;
+    }
+
+    // the first quote or backslash at or after p, the only bytes that end a run of string data
+    const char* ParseJsonReader::findStringEnd(const char* p, const char* end)
+    {
+#if defined(__AVX2__)
+        const __m256i quote = _mm256_set1_epi8('"');
+        const __m256i backslash = _mm256_set1_epi8('\\');
+
+        for (; end - p >= 32; p += 32)
+        {
+            __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            __m256i matches = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote), _mm256_cmpeq_epi8(chunk, backslash));
+            uint mask = uint(_mm256_movemask_epi8(matches));
+            if (mask)
+                return p + qCountTrailingZeroBits(mask);
+        }
+#elif defined(CGPARSE_JSON_SSE2)
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i backslash = _mm_set1_epi8('\\');
+
+        for (; end - p >= 16; p += 16)
+        {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            __m128i matches = _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash));
+            uint mask = uint(_mm_movemask_epi8(matches));
+            if (mask)
+                return p + qCountTrailingZeroBits(mask);
+        }
+#endif
+        for (; p < end; p++)
+        {
+            if (*p == '"' || *p == '\\')
+                return p;
+        }
+
+        return end;
+    }
+
+    QVariant ParseJsonReader::readValue()
+    {
+        if (_p == _end)
+            return fail();
+
+        switch (*_p)
+        {
+        case '{':
+            return readObject();
+
+        case '[':
+            return readArray();
+
+        case '"':
+        {
+            QString string;
+            if (!readString(string))
+                return fail();
+
+            return string;
+        }
+
+        case 't':
+            return readLiteral("true", 4) ? QVariant(true) : fail();
+
+        case 'f':
+            return readLiteral("false", 5) ? QVariant(false) : fail();
+
+        case 'n':
+            return readLiteral("null", 4) ? QVariant::fromValue(nullptr) : fail();
+
+        default:
+            return readNumber();
+        }
+    }
+
+    QVariant ParseJsonReader::readObject()
+    {
+        if (++_depth > MaxDepth)
+            return fail();
+
+        _p++;
+        skipWhitespace();
+
+        QVariantMap map;
+        if (_p < _end && *_p == '}')
+        {
+            _p++;
+            _depth--;
+            return map;
+        }
+
+        for (;;)
+        {
+            QString key;
+            if (_p == _end || *_p != '"' || !readString(key))
+                return fail();
+
+            skipWhitespace();
+            if (_p == _end || *_p != ':')
+                return fail();
+
+            _p++;
+            skipWhitespace();
+
+            QVariant value = readValue();
+            if (_error)
+                return QVariant();
+
+            map.insert(key, value);
+
+            skipWhitespace();
+            if (_p == _end)
+                return fail();
+
+            if (*_p == '}')
+                break;
+
+            if (*_p != ',')
+                return fail();
+
+            _p++;
+            skipWhitespace();
+        }
+
+        _p++;
+        _depth--;
+
+        return ParseConvert::decodeVariantMap(map, _identityMapped);
+    }
+
+    QVariant ParseJsonReader::readArray()
+    {
+        if (++_depth > MaxDepth)
+            return fail();
+
+        _p++;
+        skipWhitespace();
+
+        QVariantList list;
+        if (_p < _end && *_p == ']')
+        {
+            _p++;
+            _depth--;
+            return list;
+        }
+
+        for (;;)
+        {
+            QVariant value = readValue();
+            if (_error)
+                return QVariant();
+
+            list.append(value);
+
+            skipWhitespace();
+            if (_p == _end)
+                return fail();
+
+            if (*_p == ']')
+                break;
+
+            if (*_p != ',')
+                return fail();
+
+            _p++;
+            skipWhitespace();
+        }
+
+        _p++;
+        _depth--;
+
+        return list;
+    }
+
+    // integers that fit in 64 bits are qlonglong and everything else is a double, as with QJsonValue::toVariant()
+    QVariant ParseJsonReader::readNumber()
+    {
+        const char* start = _p;
+        bool integer = true;
+
+        if (_p < _end && *_p == '-')
+            _p++;
+
+        const char* digits = _p;
+        while (_p < _end)
+        {
+            char c = *_p;
+            if (c >= '0' && c <= '9')
+                _p++;
+            else if (c == '.' || c == 'e' || c == 'E' || c == '+' || c == '-')
+            {
+                integer = false;
+                _p++;
+            }
+            else
+                break;
+        }
+
+        int length = int(_p - start);
+        if (_p == digits)
+            return fail();
+
+        if (integer && _p - digits <= 18)
+        {
+            qlonglong number = 0;
+            for (const char* p = digits; p < _p; p++)
+                number = number * 10 + (*p - '0');
+
+            return *start == '-' ? -number : number;
+        }
+
+        bool ok = false;
+        QByteArray number = QByteArray::fromRawData(start, length);
+
+        if (integer)
+        {
+            qlonglong value = number.toLongLong(&ok);
+            if (ok)
+                return value;
+        }
+
+        double value = number.toDouble(&ok);
+        if (!ok)
+            return fail();
+
+        return value;
+    }
+
+    bool ParseJsonReader::readString(QString& string)
+    {
+        const char* start = _p + 1;
+        const char* p = findStringEnd(start, _end);
+        if (p == _end)
+            return false;
+
+        // short strings without escapes, every key and the class names, dates and other
+        // values that repeat across the results, are decoded once per reply and shared
+        if (*p == '"' && p - start <= MaxPooledSize)
+        {
+            QByteArrayView view(start, p - start);
+            auto it = _strings.constFind(view);
+            if (it == _strings.constEnd())
+                it = _strings.insert(view, QString::fromUtf8(view));
+
+            string = it.value();
+            _p = p + 1;
+            return true;
+        }
+
+        string = QString::fromUtf8(start, p - start);
+
+        // runs only end at ASCII quotes and backslashes, so a UTF-8 sequence is never split
+        while (*p == '\\')
+        {
+            if (++p == _end)
+                return false;
+
+            switch (*p++)
+            {
+            case '"': string += QLatin1Char('"'); break;
+            case '\\': string += QLatin1Char('\\'); break;
+            case '/': string += QLatin1Char('/'); break;
+            case 'b': string += QLatin1Char('\b'); break;
+            case 'f': string += QLatin1Char('\f'); break;
+            case 'n': string += QLatin1Char('\n'); break;
+            case 'r': string += QLatin1Char('\r'); break;
+            case 't': string += QLatin1Char('\t'); break;
+
+            case 'u':
+            {
+                // surrogate pairs are two escapes that become two UTF-16 code units
+                if (_end - p < 4)
+                    return false;
+
+                bool ok = false;
+                ushort code = QByteArray::fromRawData(p, 4).toUShort(&ok, 16);
+                if (!ok)
+                    return false;
+
+                string += QChar(code);
+                p += 4;
+                break;
+            }
+
+            default:
+                return false;
+            }
+
+            const char* next = findStringEnd(p, _end);
+            if (next == _end)
+                return false;
+
+            string += QString::fromUtf8(p, next - p);
+            p = next;
+        }
+
+        _p = p + 1;
+        return true;
+    }
+
+    bool ParseJsonReader::readLiteral(const char* literal, int size)
+    {
+        if (_end - _p < size || std::memcmp(_p, literal, size) != 0)
+            return false;
+
+        _p += size;
+        return true;
+    }
+
+    void ParseJsonReader::skipWhitespace()
+    {
+        while (_p < _end && (*_p == ' ' || *_p == '\n' || *_p == '\r' || *_p == '\t'))
+            _p++;
+    }
+
+    QVariant ParseJsonReader::fail()
+    {
+        _error = true;
+        return QVariant();
+    }
+}
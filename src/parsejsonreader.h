@@ -0,0 +1,65 @@
+/**
+* Copyright 2017 Charles Glancy (charles@glancyfamily.net)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+* files (the "Software"), to deal in the Software without restriction, including  without limitation the rights to use, copy,
+* modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+* is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+* WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#ifndef CGPARSE_PARSEJSONREADER_H
+#define CGPARSE_PARSEJSONREADER_H
+#pragma once
+
+#include "parse.h"
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QHash>
+#include <QString>
+#include <QVariant>
+
+namespace cg
+{
+    // Reads a server response straight into the QVariant values ParseConvert gives for it,
+    // without building a QJsonDocument first. Maps with a __type of Pointer, Object or File
+    // are decoded as they close. String bodies, the bulk of a Parse response, are scanned
+    // 16 or 32 bytes at a time with SSE2 or AVX2 when the compiler targets them.
+    // Keys and short values are pooled, so the objects read from one reply share them.
+    class ParseJsonReader
+    {
+    public:
+        ParseJsonReader(const QByteArray& data, bool identityMapped);
+
+        QVariant read();
+        bool hasError() const;
+
+        static const char* findStringEnd(const char* p, const char* end);
+
+    private:
+        QVariant readValue();
+        QVariant readObject();
+        QVariant readArray();
+        QVariant readNumber();
+        bool readString(QString& string);
+        bool readLiteral(const char* literal, int size);
+        void skipWhitespace();
+        QVariant fail();
+
+    private:
+        const char *_p, *_end;
+        int _depth;
+        bool _identityMapped, _error;
+
+        // views into the reply data, which outlives the reader
+        QHash<QByteArrayView, QString> _strings;
+    };
+}
+
+#endif // CGPARSE_PARSEJSONREADER_H
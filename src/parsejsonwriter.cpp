@@ -0,0 +1,223 @@
+/**
+* Copyright 2017 Charles Glancy (charles@glancyfamily.net)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+* files (the "Software"), to deal in the Software without restriction, including  without limitation the rights to use, copy,
+* modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+* is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+* WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "parsejsonwriter.h"
+#include "parseconvert.h"
+#include "parseobject.h"
+#include "parsefile.h"
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QLocale>
+
+namespace cg
+{
+    ParseJsonWriter::ParseJsonWriter(int reserve, bool parseValues)
+        : _parseValues(parseValues)
+    {
+        if (reserve > 0)
+            _data.reserve(reserve);
+    }
+
+    void ParseJsonWriter::append(char c)
+    {
+        _data.append(c);
+    }
+
+    void ParseJsonWriter::append(const char* raw)
+    {
+        _data.append(raw);
+    }
+
+    void ParseJsonWriter::append(const QByteArray& raw)
+    {
+        _data.append(raw);
+    }
+
+    void ParseJsonWriter::writeString(const QString& string)
+    {
+        writeUtf8(string.toUtf8());
+    }
+
+    // escapes the same characters as QJsonDocument, everything else is copied in runs
+    void ParseJsonWriter::writeUtf8(const QByteArray& utf8)
+    {
+        static const char hexDigits[] = "0123456789abcdef";
+
+        _data.append('"');
+
+        const char* p = utf8.constData();
+        const char* end = p + utf8.size();
+        const char* run = p;
+
+        for (; p < end; p++)
+        {
+            uchar c = uchar(*p);
+            if (c >= 0x20 && c != '"' && c != '\\')
+                continue;
+
+            _data.append(run, p - run);
+            run = p + 1;
+
+            switch (c)
+            {
+            case '"': _data.append("\\\""); break;
+            case '\\': _data.append("\\\\"); break;
+            case '\b': _data.append("\\b"); break;
+            case '\f': _data.append("\\f"); break;
+            case '\n': _data.append("\\n"); break;
+            case '\r': _data.append("\\r"); break;
+            case '\t': _data.append("\\t"); break;
+            default:
+                _data.append("\\u00");
+                _data.append(hexDigits[c >> 4]);
+                _data.append(hexDigits[c & 0xf]);
+                break;
+            }
+        }
+
+        _data.append(run, end - run);
+        _data.append('"');
+    }
+
+    void ParseJsonWriter::writeValue(const QVariant& value)
+    {
+        switch (value.typeId())
+        {
+        case QMetaType::UnknownType:
+        case QMetaType::Nullptr:
+            _data.append("null");
+            break;
+
+        case QMetaType::Bool:
+            _data.append(value.toBool() ? "true" : "false");
+            break;
+
+        case QMetaType::Int:
+        case QMetaType::UInt:
+        case QMetaType::Short:
+        case QMetaType::UShort:
+        case QMetaType::Long:
+        case QMetaType::LongLong:
+            _data.append(QByteArray::number(value.toLongLong()));
+            break;
+
+        case QMetaType::Float:
+        case QMetaType::Double:
+        {
+            double number = value.toDouble();
+            if (qIsFinite(number))
+                _data.append(QByteArray::number(number, 'g', QLocale::FloatingPointShortest));
+            else
+                _data.append("null");
+            break;
+        }
+
+        case QMetaType::QString:
+            writeString(value.toString());
+            break;
+
+        case QMetaType::QByteArray:
+            writeUtf8(value.toByteArray());
+            break;
+
+        case QMetaType::QVariantMap:
+            writeMap(value.toMap());
+            break;
+
+        case QMetaType::QVariantList:
+        case QMetaType::QStringList:
+            writeList(value.toList());
+            break;
+
+        default:
+            if (_parseValues && value.canConvert<ParseObject>())
+            {
+                ParseObject object = value.value<ParseObject>();
+                if (object.isNull())
+                    _data.append("null");
+                else
+                    writeMap(object.toPointer().toMap());
+            }
+            else if (_parseValues && value.canConvert<ParseFile>())
+            {
+                writeMap(value.value<ParseFile>().toMap());
+            }
+            else
+            {
+                // anything else is written the way QJsonValue converts it
+                writeJsonValue(QJsonValue::fromVariant(value));
+            }
+            break;
+        }
+    }
+
+    void ParseJsonWriter::writeMap(const QVariantMap& map)
+    {
+        _data.append('{');
+
+        bool first = true;
+        for (auto it = map.constBegin(); it != map.constEnd(); ++it)
+        {
+            if (_parseValues && ParseConvert::isReadOnlyKey(it.key()))
+                continue;
+
+            if (!first)
+                _data.append(',');
+            first = false;
+
+            writeString(it.key());
+            _data.append(':');
+            writeValue(it.value());
+        }
+
+        _data.append('}');
+    }
+
+    void ParseJsonWriter::writeList(const QVariantList& list)
+    {
+        _data.append('[');
+
+        for (int i = 0; i < list.size(); i++)
+        {
+            if (i > 0)
+                _data.append(',');
+
+            writeValue(list.at(i));
+        }
+
+        _data.append(']');
+    }
+
+    void ParseJsonWriter::writeJsonValue(const QJsonValue& value)
+    {
+        if (value.isObject())
+            _data.append(QJsonDocument(value.toObject()).toJson(QJsonDocument::Compact));
+        else if (value.isArray())
+            _data.append(QJsonDocument(value.toArray()).toJson(QJsonDocument::Compact));
+        else if (value.isString())
+            writeString(value.toString());
+        else if (value.isBool() || value.isDouble())
+            writeValue(value.toVariant());
+        else
+            _data.append("null");
+    }
+
+    QByteArray ParseJsonWriter::data() const
+    {
+        return _data;
+    }
+}
@@ -0,0 +1,59 @@
+/**
+* Copyright 2017 Charles Glancy (charles@glancyfamily.net)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+* files (the "Software"), to deal in the Software without restriction, including  without limitation the rights to use, copy,
+* modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+* is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+* WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#ifndef CGPARSE_PARSEJSONWRITER_H
+#define CGPARSE_PARSEJSONWRITER_H
+#pragma once
+
+#include "parse.h"
+
+#include <QByteArray>
+#include <QString>
+#include <QVariant>
+#include <QJsonValue>
+
+namespace cg
+{
+    // Serializes request bodies straight into one reserved QByteArray, without building a
+    // QJsonObject tree first. Parse values are written the way ParseConvert::toJsonObject()
+    // converts them: objects as pointers, files as file maps and read-only keys left out.
+    // The output matches QJsonDocument::toJson(QJsonDocument::Compact).
+    class ParseJsonWriter
+    {
+    public:
+        explicit ParseJsonWriter(int reserve = 0, bool parseValues = true);
+
+        void append(char c);
+        void append(const char* raw);
+        void append(const QByteArray& raw);
+
+        void writeString(const QString& string);
+        void writeValue(const QVariant& value);
+        void writeMap(const QVariantMap& map);
+        void writeList(const QVariantList& list);
+
+        QByteArray data() const;
+
+    private:
+        void writeJsonValue(const QJsonValue& value);
+        void writeUtf8(const QByteArray& utf8);
+
+    private:
+        QByteArray _data;
+        bool _parseValues;
+    };
+}
+
+#endif // CGPARSE_PARSEJSONWRITER_H
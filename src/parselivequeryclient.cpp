@@ -240,13 +240,8 @@ namespace cg {
 
     ParseObject ParseLiveQueryClient::createObject(const QJsonObject &jsonObject)
     {
+        // event objects are decoded clean, like query results
         QString className = jsonObject.value(Parse::ClassNameKey).toString();
-        QString objectId = jsonObject.value(Parse::ObjectIdKey).toString();
-        QVariantMap map = ParseConvert::toVariantMap(jsonObject);
-
-        ParseObject object = ParseObject::createWithoutData(className, objectId);
-        object.setValues(map);
-
-        return object;
+        return ParseConvert::toObject(className, jsonObject);
     }
 }
@@ -0,0 +1,559 @@
+/**
+* Copyright 2017 Charles Glancy (charles@glancyfamily.net)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+* files (the "Software"), to deal in the Software without restriction, including  without limitation the rights to use, copy,
+* modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+* is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+* WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "parsenetworkrequest.h"
+#include "parseclient.h"
+
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QRandomGenerator>
+#include <QTimer>
+#include <QUuid>
+
+#include <algorithm>
+#include <cmath>
+
+namespace cg
+{
+    QHash<QByteArray, ParseNetworkRequest*> ParseNetworkRequest::_inFlightRequests;
+    QHash<QString, ParseNetworkRequest::HostQueue> ParseNetworkRequest::_hosts;
+    int ParseNetworkRequest::_retryCount = 0;
+    int ParseNetworkRequest::_hedgeCount = 0;
+
+    // when more than one lane has requests waiting they take turns in this order, so
+    // interactive requests go first without leaving the bulk lane waiting forever
+    static const ParseRequest::Priority LaneTurns[] = {
+        ParseRequest::InteractivePriority, ParseRequest::InteractivePriority,
+        ParseRequest::InteractivePriority, ParseRequest::InteractivePriority,
+        ParseRequest::NormalPriority, ParseRequest::NormalPriority,
+        ParseRequest::BulkPriority
+    };
+    static const int TurnCount = sizeof(LaneTurns) / sizeof(LaneTurns[0]);
+
+    // the adaptive limit never goes above the streams an HTTP/2 server usually allows on a connection
+    static const int MaxAdaptiveLimit = 100;
+
+    // round trips this many times the shortest recent one mean requests are queuing on the server
+    static const int LatencyTolerance = 2;
+
+    // the shortest round trip is measured again after this many requests, in case the server got slower
+    static const int RoundTripSamples = 256;
+
+    // the hedge delay is taken from this many recent round trips, and only once there are enough of them
+    static const int RoundTripHistory = 128;
+    static const int MinHedgeSamples = 20;
+
+    // unused hedges do not pile up for a burst of slow requests
+    static const double MaxHedgeBudget = 10;
+
+    static const QByteArray RequestIdHeader = "X-Parse-Request-Id";
+
+    static qint64 elapsed()
+    {
+        static QElapsedTimer clock;
+        if (!clock.isValid())
+            clock.start();
+
+        return clock.elapsed();
+    }
+
+    ParseNetworkRequest::ParseNetworkRequest(const ParseRequest& request, QNetworkAccessManager* pNam, const QByteArray& key, bool streamed)
+        : _request(request)
+        , _pNam(pNam)
+        , _pReply(nullptr)
+        , _pHedgeReply(nullptr)
+        , _replyStart(0)
+        , _hedgeStart(0)
+        , _key(key)
+        , _streamed(streamed)
+        , _attempts(0)
+        , _replyCount(0)
+        , _dataEmitted(false)
+        , _cancelled(false)
+    {
+        _host = hostKey(_request.networkRequest().url());
+
+        // every attempt carries the same id, so the server can tell a retry from a new request
+        ParseRequest::HttpMethod method = _request.httpMethod();
+        if (_request.retryPolicy().maxAttempts > 1 && (method == ParseRequest::PostHttpMethod || method == ParseRequest::PutHttpMethod) &&
+            _request.header(RequestIdHeader).isEmpty())
+        {
+            _request.setHeader(RequestIdHeader, QUuid::createUuid().toByteArray(QUuid::WithoutBraces));
+        }
+
+        if (!_key.isEmpty())
+            _inFlightRequests.insert(_key, this);
+
+        _hedgeTimer.setSingleShot(true);
+        connect(&_hedgeTimer, &QTimer::timeout, this, &ParseNetworkRequest::hedge);
+    }
+
+    ParseNetworkRequest::~ParseNetworkRequest()
+    {
+        if (!_key.isEmpty() && _inFlightRequests.value(_key) == this)
+            _inFlightRequests.remove(_key);
+    }
+
+    // a GET that is already in flight with the same url, query and headers is shared instead of sent again
+    ParseNetworkRequest* ParseNetworkRequest::send(const ParseRequest& request, QNetworkAccessManager* pNam, bool streamed)
+    {
+        if (!pNam)
+            pNam = ParseClient::networkAccessManager();
+
+        QByteArray key = streamed ? QByteArray() : requestKey(request, pNam);
+        if (!key.isEmpty())
+        {
+            ParseNetworkRequest *pNetworkRequest = _inFlightRequests.value(key);
+            if (pNetworkRequest)
+            {
+                pNetworkRequest->promote(request.priority());
+                pNetworkRequest->_replyCount++;
+                return pNetworkRequest;
+            }
+        }
+
+        ParseNetworkRequest *pNetworkRequest = new ParseNetworkRequest(request, pNam, key, streamed);
+        pNetworkRequest->_replyCount++;
+        _hosts[pNetworkRequest->_host].lanes[request.priority()].append(pNetworkRequest);
+        schedule(pNetworkRequest->_host);
+
+        return pNetworkRequest;
+    }
+
+    // a reply that no longer wants the result lets go of the request, the last one cancels it
+    // so a waiting request never starts and one in flight frees its connection
+    void ParseNetworkRequest::release()
+    {
+        if (--_replyCount > 0 || _cancelled)
+            return;
+
+        _cancelled = true;
+        _hedgeTimer.stop();
+
+        if (!_key.isEmpty() && _inFlightRequests.value(_key) == this)
+            _inFlightRequests.remove(_key);
+
+        if (_pHedgeReply)
+        {
+            abandon(_pHedgeReply);
+            _pHedgeReply = nullptr;
+        }
+
+        if (_pReply)
+        {
+            // replyFinished() follows and frees the slot
+            _pReply->abort();
+            return;
+        }
+
+        // still waiting in its lane or for a retry
+        _hosts[_host].lanes[_request.priority()].removeOne(this);
+        deleteLater();
+    }
+
+    // the number of requests the server of the url may have in flight, 0 for no limit
+    int ParseNetworkRequest::requestLimit(const QUrl& url)
+    {
+        auto it = _hosts.constFind(hostKey(url));
+        if (ParseClient::get()->isAdaptiveConcurrencyEnabled() && it != _hosts.constEnd() && it->limit > 0)
+            return int(it->limit);
+
+        return qMax(0, ParseClient::get()->maxRequestsPerHost());
+    }
+
+    int ParseNetworkRequest::queuedRequestCount(const QUrl& url)
+    {
+        auto it = _hosts.constFind(hostKey(url));
+        if (it == _hosts.constEnd())
+            return 0;
+
+        int count = 0;
+        for (int lane = 0; lane < LaneCount; lane++)
+            count += it->lanes[lane].size();
+
+        return count;
+    }
+
+    int ParseNetworkRequest::retriedRequestCount()
+    {
+        return _retryCount;
+    }
+
+    int ParseNetworkRequest::hedgedRequestCount()
+    {
+        return _hedgeCount;
+    }
+
+    QString ParseNetworkRequest::hostKey(const QUrl& url)
+    {
+        return url.adjusted(QUrl::RemoveUserInfo | QUrl::RemovePath | QUrl::RemoveQuery | QUrl::RemoveFragment).toString();
+    }
+
+    QByteArray ParseNetworkRequest::requestKey(const ParseRequest& request, QNetworkAccessManager* pNam)
+    {
+        if (request.httpMethod() != ParseRequest::GetHttpMethod)
+            return QByteArray();
+
+        QByteArray key = QByteArray::number(quintptr(pNam)) + " " + request.networkRequest().url().toEncoded();
+
+        for (auto it = request._headers.constBegin(); it != request._headers.constEnd(); ++it)
+            key += "\n" + it.key() + ": " + it.value();
+
+        return key;
+    }
+
+    // the limit of requests in flight to one server for a lane, 0 when only the total is limited
+    int ParseNetworkRequest::laneLimit(ParseRequest::Priority priority)
+    {
+        switch (priority)
+        {
+        case ParseRequest::InteractivePriority:
+            return ParseClient::get()->maxInteractiveRequestsPerHost();
+        case ParseRequest::NormalPriority:
+            return ParseClient::get()->maxNormalRequestsPerHost();
+        case ParseRequest::BulkPriority:
+            return ParseClient::get()->maxBulkRequestsPerHost();
+        }
+
+        return 0;
+    }
+
+    // starts waiting requests of the host while it has free slots, taking the lanes in turn
+    void ParseNetworkRequest::schedule(const QString& host)
+    {
+        auto it = _hosts.find(host);
+        if (it == _hosts.end())
+            return;
+
+        HostQueue& queue = it.value();
+        int maxRequests = ParseClient::get()->maxRequestsPerHost();
+
+        // the adaptive limit starts from the configured one
+        if (ParseClient::get()->isAdaptiveConcurrencyEnabled())
+        {
+            if (queue.limit <= 0)
+                queue.limit = maxRequests > 0 ? maxRequests : MaxAdaptiveLimit;
+
+            maxRequests = int(queue.limit);
+        }
+
+        while (maxRequests <= 0 || queue.inFlight < maxRequests)
+        {
+            ParseNetworkRequest *pNext = nullptr;
+
+            for (int i = 0; i < TurnCount && !pNext; i++)
+            {
+                int lane = LaneTurns[(queue.turn + i) % TurnCount];
+                if (queue.lanes[lane].isEmpty())
+                    continue;
+
+                int maxLaneRequests = laneLimit(ParseRequest::Priority(lane));
+                if (maxLaneRequests > 0 && queue.laneInFlight[lane] >= maxLaneRequests)
+                    continue;
+
+                pNext = queue.lanes[lane].takeFirst();
+                queue.turn = (queue.turn + i + 1) % TurnCount;
+            }
+
+            if (!pNext)
+                break;
+
+            queue.laneInFlight[pNext->_request.priority()]++;
+            queue.inFlight++;
+            pNext->start();
+        }
+    }
+
+    // additive increase while the server keeps up, multiplicative decrease when it throttles,
+    // is overloaded or its round trips grow, at most once per round trip so one burst of slow
+    // replies only counts once
+    void ParseNetworkRequest::adaptLimit(const QString& host, int status, qint64 roundTrip)
+    {
+        HostQueue& queue = _hosts[host];
+        if (queue.limit <= 0)
+            return;
+
+        if (queue.minRoundTrip < 0 || roundTrip < queue.minRoundTrip || ++queue.samples >= RoundTripSamples)
+        {
+            queue.minRoundTrip = roundTrip;
+            queue.samples = 0;
+        }
+
+        bool throttled = status == 429 || status == 503;
+        bool queuing = roundTrip > queue.minRoundTrip * LatencyTolerance;
+
+        if (throttled || queuing)
+        {
+            qint64 now = elapsed();
+            if (queue.lastDecrease < 0 || now - queue.lastDecrease >= qMax(queue.minRoundTrip, qint64(1)))
+            {
+                queue.limit = qMax(1.0, queue.limit * (throttled ? 0.5 : 0.9));
+                queue.lastDecrease = now;
+            }
+        }
+        else if (queue.inFlight + 1 >= int(queue.limit))
+        {
+            // only a limit that is actually reached is raised
+            queue.limit = qMin(double(MaxAdaptiveLimit), queue.limit + 1.0 / queue.limit);
+        }
+    }
+
+    // keeps a ring of the latest GET round trips to the server
+    void ParseNetworkRequest::recordRoundTrip(const QString& host, qint64 roundTrip)
+    {
+        HostQueue& queue = _hosts[host];
+        if (queue.roundTrips.size() < RoundTripHistory)
+            queue.roundTrips.append(roundTrip);
+        else
+            queue.roundTrips[queue.nextRoundTrip] = roundTrip;
+
+        queue.nextRoundTrip = (queue.nextRoundTrip + 1) % RoundTripHistory;
+    }
+
+    void ParseNetworkRequest::start()
+    {
+        _attempts++;
+        _timer.start();
+        _replyStart = 0;
+        _pReply = _request.sendRequest(_pNam);
+        connect(_pReply, &QNetworkReply::finished, this, &ParseNetworkRequest::replyFinished);
+
+        if (_streamed)
+            connect(_pReply, &QNetworkReply::readyRead, this, &ParseNetworkRequest::replyReadyRead);
+
+        if (isHedgeable())
+        {
+            HostQueue& queue = _hosts[_host];
+            if (_attempts == 1)
+                queue.hedgeBudget = qMin(MaxHedgeBudget, queue.hedgeBudget + qMax(0, _request.hedgePolicy().budgetPercent) / 100.0);
+
+            int delay = hedgeDelay();
+            if (delay >= 0)
+                _hedgeTimer.start(delay);
+        }
+    }
+
+    void ParseNetworkRequest::freeSlot()
+    {
+        HostQueue& queue = _hosts[_host];
+        queue.laneInFlight[_request.priority()]--;
+        queue.inFlight--;
+    }
+
+    // a reply whose result is no longer needed stops without reporting back
+    void ParseNetworkRequest::abandon(QNetworkReply* pReply)
+    {
+        disconnect(pReply, nullptr, this, nullptr);
+        pReply->abort();
+        pReply->deleteLater();
+        freeSlot();
+    }
+
+    // a shared request that is still waiting moves up to the lane of its most urgent reply
+    void ParseNetworkRequest::promote(ParseRequest::Priority priority)
+    {
+        if (_pReply || priority >= _request.priority())
+            return;
+
+        HostQueue& queue = _hosts[_host];
+        if (queue.lanes[_request.priority()].removeOne(this))
+            queue.lanes[priority].append(this);
+
+        _request.setPriority(priority);
+    }
+
+    void ParseNetworkRequest::replyReadyRead()
+    {
+        QByteArray data = _pReply->readAll();
+        if (!data.isEmpty())
+        {
+            _dataEmitted = true;
+            emit dataAvailable(data);
+        }
+    }
+
+    // transient failures are retried while the policy allows, a streamed request only until it has handed over data
+    bool ParseNetworkRequest::isRetryable(int status) const
+    {
+        const ParseRetryPolicy &policy = _request.retryPolicy();
+        if (_attempts >= policy.maxAttempts || _dataEmitted || _cancelled)
+            return false;
+
+        if (status != 0)
+            return policy.retryableStatusCodes.contains(status);
+
+        if (!policy.retryNetworkErrors)
+            return false;
+
+        switch (_pReply->error())
+        {
+        case QNetworkReply::ConnectionRefusedError:
+        case QNetworkReply::RemoteHostClosedError:
+        case QNetworkReply::TimeoutError:
+        case QNetworkReply::TemporaryNetworkFailureError:
+        case QNetworkReply::NetworkSessionFailedError:
+        case QNetworkReply::ProxyConnectionClosedError:
+        case QNetworkReply::ProxyTimeoutError:
+        case QNetworkReply::UnknownNetworkError:
+        case QNetworkReply::OperationCanceledError:     // the transfer timeout aborts the reply
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    // a random delay up to the backoff of this attempt, or longer when the server asks for it
+    int ParseNetworkRequest::retryDelay() const
+    {
+        const ParseRetryPolicy &policy = _request.retryPolicy();
+        qint64 backoff = qint64(qMax(0, policy.initialDelay)) << qMin(_attempts - 1, 20);
+        int delay = int(QRandomGenerator::global()->bounded(qMin(backoff, qint64(qMax(0, policy.maxDelay))) + 1));
+
+        bool ok = false;
+        int retryAfter = _pReply->rawHeader("Retry-After").toInt(&ok);
+        if (ok && retryAfter > 0)
+            delay = qMax(delay, int(qMin(qint64(retryAfter) * 1000, qint64(qMax(0, policy.maxDelay)))));
+
+        return delay;
+    }
+
+    // only GETs are safe to send twice, streamed replies cannot be swapped halfway and bulk ones are not waited on
+    bool ParseNetworkRequest::isHedgeable() const
+    {
+        return _request.hedgePolicy().enabled && _request.httpMethod() == ParseRequest::GetHttpMethod &&
+            !_streamed && _request.priority() != ParseRequest::BulkPriority;
+    }
+
+    // the percentile of recent round trips to the server, -1 while there are too few to tell what is slow
+    int ParseNetworkRequest::hedgeDelay() const
+    {
+        auto it = _hosts.constFind(_host);
+        if (it == _hosts.constEnd() || it->roundTrips.size() < MinHedgeSamples)
+            return -1;
+
+        QList<qint64> roundTrips = it->roundTrips;
+
+        double percentile = qBound(0.0, _request.hedgePolicy().percentile, 100.0);
+        int index = qBound(0, int(std::ceil(percentile / 100.0 * roundTrips.size())) - 1, int(roundTrips.size()) - 1);
+        std::nth_element(roundTrips.begin(), roundTrips.begin() + index, roundTrips.end());
+
+        return int(qMax(qint64(1), roundTrips.at(index)));
+    }
+
+    // sends the duplicate of a slow GET while the budget and a free slot on the server allow it
+    void ParseNetworkRequest::hedge()
+    {
+        if (!_pReply || _pHedgeReply || _cancelled)
+            return;
+
+        HostQueue& queue = _hosts[_host];
+        int limit = requestLimit(_request.networkRequest().url());
+        int maxLaneRequests = laneLimit(_request.priority());
+        if (queue.hedgeBudget < 1 || (limit > 0 && queue.inFlight >= limit) ||
+            (maxLaneRequests > 0 && queue.laneInFlight[_request.priority()] >= maxLaneRequests))
+            return;
+
+        queue.hedgeBudget -= 1;
+        queue.laneInFlight[_request.priority()]++;
+        queue.inFlight++;
+        _hedgeCount++;
+
+        _hedgeStart = _timer.elapsed();
+        _pHedgeReply = _request.sendRequest(_pNam);
+        connect(_pHedgeReply, &QNetworkReply::finished, this, &ParseNetworkRequest::replyFinished);
+    }
+
+    // the same request, body included, waits in its lane again
+    void ParseNetworkRequest::retry()
+    {
+        _hosts[_host].lanes[_request.priority()].append(this);
+        schedule(_host);
+    }
+
+    void ParseNetworkRequest::replyFinished()
+    {
+        // when the hedge answers first it becomes the reply and the original is the one left over
+        if (sender() && sender() == _pHedgeReply)
+        {
+            std::swap(_pReply, _pHedgeReply);
+            std::swap(_replyStart, _hedgeStart);
+        }
+
+        int status = _pReply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        qint64 roundTrip = _timer.elapsed() - _replyStart;
+
+        // the slot is handed to the next waiting request before the result is handled
+        freeSlot();
+
+        // a streamed reply takes as long as its results and a cancelled one was cut short,
+        // their round trips say nothing about the server
+        if (!_streamed && !_cancelled)
+        {
+            if (ParseClient::get()->isAdaptiveConcurrencyEnabled())
+                adaptLimit(_host, status, roundTrip);
+
+            if (status != 0 && _request.httpMethod() == ParseRequest::GetHttpMethod)
+                recordRoundTrip(_host, roundTrip);
+        }
+
+        if (_pHedgeReply)
+        {
+            // a failed reply leaves the result to the other one, which is still in flight
+            if (!_cancelled && (status == 0 || status >= 500))
+            {
+                _pReply->deleteLater();
+                _pReply = _pHedgeReply;
+                _replyStart = _hedgeStart;
+                _pHedgeReply = nullptr;
+                schedule(_host);
+                return;
+            }
+
+            abandon(_pHedgeReply);
+            _pHedgeReply = nullptr;
+        }
+
+        _hedgeTimer.stop();
+        schedule(_host);
+
+        if (isRetryable(status))
+        {
+            _retryCount++;
+            QTimer::singleShot(retryDelay(), this, &ParseNetworkRequest::retry);
+            _pReply->deleteLater();
+            _pReply = nullptr;
+            return;
+        }
+
+        // later identical requests are sent again rather than sharing a finished reply
+        if (!_key.isEmpty() && _inFlightRequests.value(_key) == this)
+            _inFlightRequests.remove(_key);
+
+        QByteArray data = _pReply->readAll();
+
+        // a streamed request has already handed over everything but the last chunk
+        if (_streamed)
+        {
+            if (!data.isEmpty())
+                emit dataAvailable(data);
+            data.clear();
+        }
+
+        emit finished(status, data);
+
+        _pReply->deleteLater();
+        deleteLater();
+    }
+}
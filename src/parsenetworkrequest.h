@@ -0,0 +1,123 @@
+/**
+* Copyright 2017 Charles Glancy (charles@glancyfamily.net)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+* files (the "Software"), to deal in the Software without restriction, including  without limitation the rights to use, copy,
+* modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+* is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+* WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#ifndef CGPARSE_PARSENETWORKREQUEST_H
+#define CGPARSE_PARSENETWORKREQUEST_H
+#pragma once
+
+#include "parse.h"
+#include "parserequest.h"
+
+#include <QObject>
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QElapsedTimer>
+#include <QTimer>
+
+class QNetworkReply;
+class QNetworkAccessManager;
+
+namespace cg
+{
+    // Owns the QNetworkReply of a request and hands its result to every ParseReply
+    // waiting on it. Identical GET requests that are in flight at the same time share
+    // one ParseNetworkRequest, so they are only sent once. A streamed request is never
+    // shared, it hands each chunk to dataAvailable() as it arrives instead of buffering.
+    // Requests wait in a lane for their priority until their server has a free slot, and
+    // go back to it after a transient failure while their retry policy allows. A slow GET
+    // can be hedged with a second reply, the first to answer wins and the other is aborted.
+    class ParseNetworkRequest : public QObject
+    {
+        Q_OBJECT
+    public:
+        static ParseNetworkRequest* send(const ParseRequest& request, QNetworkAccessManager* pNam, bool streamed = false);
+        static int requestLimit(const QUrl& url);
+        static int queuedRequestCount(const QUrl& url);
+        static int retriedRequestCount();
+        static int hedgedRequestCount();
+
+        void release();
+
+    signals:
+        void dataAvailable(const QByteArray& data);
+        void finished(int status, const QByteArray& data);
+
+    private slots:
+        void replyReadyRead();
+        void replyFinished();
+        void retry();
+        void hedge();
+
+    private:
+        ParseNetworkRequest(const ParseRequest& request, QNetworkAccessManager* pNam, const QByteArray& key, bool streamed);
+        ~ParseNetworkRequest();
+
+        void start();
+        void promote(ParseRequest::Priority priority);
+        bool isRetryable(int status) const;
+        int retryDelay() const;
+        bool isHedgeable() const;
+        int hedgeDelay() const;
+        void freeSlot();
+        void abandon(QNetworkReply* pReply);
+
+        static QByteArray requestKey(const ParseRequest& request, QNetworkAccessManager* pNam);
+        static QString hostKey(const QUrl& url);
+        static void schedule(const QString& host);
+        static int laneLimit(ParseRequest::Priority priority);
+        static void adaptLimit(const QString& host, int status, qint64 roundTrip);
+        static void recordRoundTrip(const QString& host, qint64 roundTrip);
+
+        static const int LaneCount = ParseRequest::BulkPriority + 1;
+
+        // the requests to one server waiting in each lane and the number in flight, with
+        // adaptive concurrency the limit and the shortest recent round trip are learned per server,
+        // recent GET round trips set the hedge delay and each hedgeable request adds to the budget
+        struct HostQueue
+        {
+            QList<ParseNetworkRequest*> lanes[LaneCount];
+            int laneInFlight[LaneCount] = {};
+            int inFlight = 0;
+            int turn = 0;
+            double limit = 0;
+            qint64 minRoundTrip = -1;
+            qint64 lastDecrease = -1;
+            int samples = 0;
+            QList<qint64> roundTrips;
+            int nextRoundTrip = 0;
+            double hedgeBudget = 0;
+        };
+
+    private:
+        static QHash<QByteArray, ParseNetworkRequest*> _inFlightRequests;
+        static QHash<QString, HostQueue> _hosts;
+        static int _retryCount, _hedgeCount;
+        ParseRequest _request;
+        QNetworkAccessManager* _pNam;
+        QNetworkReply* _pReply;
+        QNetworkReply* _pHedgeReply;
+        QTimer _hedgeTimer;
+        qint64 _replyStart, _hedgeStart;
+        QByteArray _key;
+        QString _host;
+        QElapsedTimer _timer;
+        bool _streamed;
+        int _attempts, _replyCount;
+        bool _dataEmitted, _cancelled;
+    };
+}
+
+#endif // CGPARSE_PARSENETWORKREQUEST_H
@@ -90,54 +90,35 @@ namespace cg
 
     bool ParseObject::isDirty() const
     {
-        for (auto & key : keys())
-        {
-            if (isDirty(key))
-                return true;
-        }
-
-        return false;
+        return _pImpl ? _pImpl->isDirty() : false;
     }
 
     bool ParseObject::isDirty(const QString &key) const
     {
-        if (!_pImpl)
-            return false;
-
-        bool dirty = true;
-
-        bool inValueMap = _pImpl->valueMap.contains(key);
-        bool inSavedMap = _pImpl->savedValueMap.contains(key);
-
-        if (inValueMap && inSavedMap)
-        {
-            if (value(key) == _pImpl->savedValueMap.value(key))
-                dirty = false;
-        }
-        else if (!inValueMap && !inSavedMap)
-        {
-            dirty = false;
-        }
+        return _pImpl ? _pImpl->isDirty(key) : false;
+    }
 
-        return dirty;
+    QStringList ParseObject::dirtyKeys() const
+    {
+        return _pImpl ? QStringList(_pImpl->dirtyKeys.begin(), _pImpl->dirtyKeys.end()) : QStringList();
     }
 
     void ParseObject::revert()
     {
         if (_pImpl)
-            _pImpl->valueMap = _pImpl->savedValueMap;
+            _pImpl->revert();
     }
 
     void ParseObject::revert(const QString &key)
     {
         if (_pImpl)
-            _pImpl->valueMap.insert(key, _pImpl->savedValueMap.value(key));
+            _pImpl->revert(key);
     }
 
     void ParseObject::clearDirtyState()
     {
         if (_pImpl)
-            _pImpl->savedValueMap = _pImpl->valueMap;
+            _pImpl->clearDirtyState();
     }
 
     bool ParseObject::hasSameId(const ParseObject& object) const
@@ -167,13 +148,13 @@ namespace cg
 
     QVariant ParseObject::value(const QString &key) const
     {
-        return _pImpl ? _pImpl->valueMap.value(key) : QVariant();
+        return _pImpl ? _pImpl->value(key) : QVariant();
     }
 
     void ParseObject::setValue(const QString &key, const QVariant &variant)
     {
         if (_pImpl)
-            _pImpl->valueMap.insert(key, variant);
+            _pImpl->setValue(key, variant);
     }
 
     void ParseObject::remove(const QString & key)
@@ -296,13 +277,12 @@ namespace cg
 
     bool ParseObject::contains(const QString &key) const
     {
-        QStringList list = keys();
-        return list.contains(key);
+        return _pImpl ? _pImpl->contains(key) : false;
     }
 
     QStringList ParseObject::keys() const
     {
-        return _pImpl ? _pImpl->valueMap.keys() : QStringList();
+        return _pImpl ? _pImpl->keys() : QStringList();
     }
 
     bool ParseObject::isUserValue(const QString &key)
@@ -315,7 +295,7 @@ namespace cg
 
     bool ParseObject::valueMapHasKey(const QString& key) const
     {
-        return _pImpl->valueMap.contains(key);
+        return _pImpl->contains(key);
     }
 
     ParseObjectPointer ParseObject::toPointer() const
@@ -325,7 +305,7 @@ namespace cg
 
     QVariantMap ParseObject::toMap() const
     {
-        return _pImpl ? _pImpl->valueMap : QVariantMap();
+        return _pImpl ? _pImpl->toMap() : QVariantMap();
     }
 
     void ParseObject::setValues(const QVariantMap &variantMap)
@@ -333,13 +313,19 @@ namespace cg
         if (!_pImpl)
             return;
 
-        for (auto& key : variantMap.keys())
+        for (auto it = variantMap.constBegin(); it != variantMap.constEnd(); ++it)
         {
-            if (key != Parse::TypeKey)
-                _pImpl->valueMap.insert(key, variantMap.value(key));
+            if (it.key() != Parse::TypeKey)
+                _pImpl->setValue(it.key(), it.value());
         }
     }
 
+    void ParseObject::setServerValues(const QVariantMap &variantMap)
+    {
+        if (_pImpl)
+            _pImpl->setServerValues(variantMap);
+    }
+
     ParseReply* ParseObject::save(QNetworkAccessManager* pNam)
     {
         ParseReply *pReply = nullptr;
@@ -14,11 +14,394 @@
 * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 #include "parseobjectimpl.h"
+#include "parse.h"
+
+#include <QMutexLocker>
+
+#include <algorithm>
 
 namespace cg
 {
+	// a class whose objects keep changing keys stops registering new shapes
+	static const int MaxShapesPerClass = 64;
+
+	QMutex ParseObjectShape::_mutex;
+	QHash<QString, QList<QSharedPointer<const ParseObjectShape>>> ParseObjectShape::_shapes;
+
+	QHash<QString, QWeakPointer<ParseObjectImpl>> ParseObjectImpl::_identityMap;
+	int ParseObjectImpl::_identityMapPruneSize = 1024;
+
+	//
+	// ParseObjectShape
+	//
+	ParseObjectShape::ParseObjectShape(const QStringList& keysArg)
+		: keys(keysArg)
+	{
+		_slotIndex.reserve(keys.size());
+		for (int i = 0; i < keys.size(); i++)
+			_slotIndex.insert(keys.at(i), i);
+	}
+
+	int ParseObjectShape::slot(const QString& key) const
+	{
+		return _slotIndex.value(key, -1);
+	}
+
+	// the keys of the map, apart from the type key, are the keys of the shape
+	bool ParseObjectShape::matches(const QVariantMap& map) const
+	{
+		int i = 0;
+		for (auto it = map.keyBegin(); it != map.keyEnd(); ++it)
+		{
+			if (*it == Parse::TypeKey)
+				continue;
+
+			if (i >= keys.size() || keys.at(i) != *it)
+				return false;
+
+			i++;
+		}
+
+		return i == keys.size();
+	}
+
+	QSharedPointer<const ParseObjectShape> ParseObjectShape::find(const QString& className, const QVariantMap& map)
+	{
+		{
+			QMutexLocker locker(&_mutex);
+
+			auto& shapes = _shapes[className];
+			for (int i = 0; i < shapes.size(); i++)
+			{
+				if (shapes.at(i)->matches(map))
+				{
+					// the results of a query usually share one shape, keep the last match first
+					if (i > 0)
+						shapes.move(i, 0);
+
+					return shapes.first();
+				}
+			}
+		}
+
+		QStringList keys;
+		keys.reserve(map.size());
+
+		for (auto it = map.keyBegin(); it != map.keyEnd(); ++it)
+		{
+			if (*it != Parse::TypeKey)
+				keys.append(*it);
+		}
+
+		return find(className, keys);
+	}
+
+	QSharedPointer<const ParseObjectShape> ParseObjectShape::find(const QString& className, const QStringList& keys)
+	{
+		QMutexLocker locker(&_mutex);
+
+		auto& shapes = _shapes[className];
+		for (auto& pShape : shapes)
+		{
+			if (pShape->keys == keys)
+				return pShape;
+		}
+
+		QSharedPointer<const ParseObjectShape> pShape = QSharedPointer<ParseObjectShape>::create(keys);
+		if (shapes.size() < MaxShapesPerClass)
+			shapes.append(pShape);
+
+		return pShape;
+	}
+
+	// the shape with one more key, transitions are remembered so objects built the same way share shapes
+	QSharedPointer<const ParseObjectShape> ParseObjectShape::withKey(const QString& className, const QSharedPointer<const ParseObjectShape>& pShape, const QString& key)
+	{
+		QStringList keys;
+
+		if (pShape)
+		{
+			QMutexLocker locker(&_mutex);
+
+			QSharedPointer<const ParseObjectShape> pNextShape = pShape->_transitions.value(key);
+			if (pNextShape)
+				return pNextShape;
+
+			keys = pShape->keys;
+		}
+
+		keys.insert(std::lower_bound(keys.begin(), keys.end(), key), key);
+		QSharedPointer<const ParseObjectShape> pNextShape = find(className, keys);
+
+		// a shape past the limit of its class is not registered, a transition to it would keep it alive
+		if (pShape)
+		{
+			QMutexLocker locker(&_mutex);
+			if (_shapes.value(className).contains(pNextShape))
+				pShape->_transitions.insert(key, pNextShape);
+		}
+
+		return pNextShape;
+	}
+
+	//
+	// ParseObjectImpl
+	//
 	ParseObjectImpl::ParseObjectImpl(const QString& classNameArg)
 		: className(classNameArg)
 	{
 	}
-}
\ No newline at end of file
+
+	QVariant ParseObjectImpl::value(const QString& key) const
+	{
+		int slot = _pShape ? _pShape->slot(key) : -1;
+		return slot >= 0 && _present.testBit(slot) ? _values.at(slot) : QVariant();
+	}
+
+	bool ParseObjectImpl::contains(const QString& key) const
+	{
+		int slot = _pShape ? _pShape->slot(key) : -1;
+		return slot >= 0 && _present.testBit(slot);
+	}
+
+	QStringList ParseObjectImpl::keys() const
+	{
+		QStringList keys;
+
+		for (int i = 0; i < _values.size(); i++)
+		{
+			if (_present.testBit(i))
+				keys.append(_pShape->keys.at(i));
+		}
+
+		return keys;
+	}
+
+	QVariantMap ParseObjectImpl::toMap() const
+	{
+		QVariantMap map;
+
+		// shape keys are sorted so every insert goes at the end
+		for (int i = 0; i < _values.size(); i++)
+		{
+			if (_present.testBit(i))
+				map.insert(map.constEnd(), _pShape->keys.at(i), _values.at(i));
+		}
+
+		return map;
+	}
+
+	bool ParseObjectImpl::isEmpty() const
+	{
+		return _present.count(true) == 0;
+	}
+
+	void ParseObjectImpl::insert(const QString& key, const QVariant& value)
+	{
+		int slot = _pShape ? _pShape->slot(key) : -1;
+
+		if (slot < 0)
+		{
+			setShape(ParseObjectShape::withKey(className, _pShape, key));
+			slot = _pShape->slot(key);
+		}
+
+		_values[slot] = value;
+		_present.setBit(slot);
+	}
+
+	// moves the values to their slots in a shape that has at least the current keys
+	void ParseObjectImpl::setShape(const QSharedPointer<const ParseObjectShape>& pShape)
+	{
+		QList<QVariant> values(pShape->keys.size());
+		QBitArray present(pShape->keys.size());
+
+		for (int i = 0; i < _values.size(); i++)
+		{
+			if (!_present.testBit(i))
+				continue;
+
+			int slot = pShape->slot(_pShape->keys.at(i));
+			values[slot] = _values.at(i);
+			present.setBit(slot);
+		}
+
+		_pShape = pShape;
+		_values = values;
+		_present = present;
+	}
+
+	void ParseObjectImpl::remove(const QString& key)
+	{
+		int slot = _pShape ? _pShape->slot(key) : -1;
+		if (slot < 0)
+			return;
+
+		_values[slot] = QVariant();
+		_present.clearBit(slot);
+	}
+
+	void ParseObjectImpl::setValue(const QString& key, const QVariant& value)
+	{
+		if (!dirtyKeys.contains(key))
+		{
+			if (contains(key))
+				savedValueMap.insert(key, this->value(key));
+
+			dirtyKeys.insert(key);
+		}
+
+		insert(key, value);
+
+		// setting a key back to its saved value makes it clean again
+		auto it = savedValueMap.constFind(key);
+		if (it != savedValueMap.constEnd() && it.value() == value)
+		{
+			dirtyKeys.remove(key);
+			savedValueMap.remove(key);
+		}
+	}
+
+	bool ParseObjectImpl::isDirty() const
+	{
+		return !dirtyKeys.isEmpty();
+	}
+
+	bool ParseObjectImpl::isDirty(const QString& key) const
+	{
+		return dirtyKeys.contains(key);
+	}
+
+	void ParseObjectImpl::revert()
+	{
+		for (auto& key : dirtyKeys)
+		{
+			auto it = savedValueMap.constFind(key);
+			if (it != savedValueMap.constEnd())
+				insert(key, it.value());
+			else
+				remove(key);
+		}
+
+		clearDirtyState();
+	}
+
+	void ParseObjectImpl::revert(const QString& key)
+	{
+		if (!dirtyKeys.contains(key))
+			return;
+
+		auto it = savedValueMap.constFind(key);
+		if (it != savedValueMap.constEnd())
+			insert(key, it.value());
+		else
+			remove(key);
+
+		dirtyKeys.remove(key);
+		savedValueMap.remove(key);
+	}
+
+	void ParseObjectImpl::clearDirtyState()
+	{
+		dirtyKeys.clear();
+		savedValueMap.clear();
+	}
+
+	// merges values received from the server, keys with unsaved changes keep their value
+	void ParseObjectImpl::mergeValues(const QVariantMap& map)
+	{
+		// a new object takes the whole map, in the order of its shape
+		if (isEmpty() && dirtyKeys.isEmpty())
+		{
+			_pShape = ParseObjectShape::find(className, map);
+			_values.clear();
+			_values.reserve(_pShape->keys.size());
+
+			for (auto it = map.constBegin(); it != map.constEnd(); ++it)
+			{
+				if (it.key() != Parse::TypeKey)
+					_values.append(it.value());
+			}
+
+			_present = QBitArray(_values.size(), true);
+			return;
+		}
+
+		// move to a shape with all the new keys at once rather than one key at a time
+		QStringList keys = _pShape ? _pShape->keys : QStringList();
+		int keyCount = keys.size();
+
+		for (auto it = map.keyBegin(); it != map.keyEnd(); ++it)
+		{
+			if (*it != Parse::TypeKey && (!_pShape || _pShape->slot(*it) < 0))
+				keys.append(*it);
+		}
+
+		if (keys.size() > keyCount)
+		{
+			std::sort(keys.begin(), keys.end());
+			setShape(ParseObjectShape::find(className, keys));
+		}
+
+		for (auto it = map.constBegin(); it != map.constEnd(); ++it)
+		{
+			if (it.key() == Parse::TypeKey)
+				continue;
+
+			if (!dirtyKeys.contains(it.key()))
+			{
+				insert(it.key(), it.value());
+			}
+			else if (value(it.key()) == it.value())
+			{
+				dirtyKeys.remove(it.key());
+				savedValueMap.remove(it.key());
+			}
+			else
+			{
+				savedValueMap.insert(it.key(), it.value());
+			}
+		}
+	}
+
+	// values the server has confirmed replace the local ones and leave the object clean,
+	// without snapshotting the values they replace
+	void ParseObjectImpl::setServerValues(const QVariantMap& map)
+	{
+		clearDirtyState();
+		mergeValues(map);
+	}
+
+	// returns the one instance shared by every decoded copy of an object, the map only holds
+	// weak references so instances are freed when the last ParseObject using them goes away
+	QSharedPointer<ParseObjectImpl> ParseObjectImpl::identity(const QString& className, const QString& objectId)
+	{
+		QString key = className + "/" + objectId;
+		QSharedPointer<ParseObjectImpl> pImpl = _identityMap.value(key).toStrongRef();
+
+		if (!pImpl)
+		{
+			if (_identityMap.size() >= _identityMapPruneSize)
+				pruneIdentityMap();
+
+			pImpl = QSharedPointer<ParseObjectImpl>::create(className);
+			pImpl->insert(Parse::ObjectIdKey, objectId);
+			_identityMap.insert(key, pImpl);
+		}
+
+		return pImpl;
+	}
+
+	void ParseObjectImpl::pruneIdentityMap()
+	{
+		for (auto it = _identityMap.begin(); it != _identityMap.end();)
+		{
+			if (it.value().isNull())
+				it = _identityMap.erase(it);
+			else
+				++it;
+		}
+
+		_identityMapPruneSize = qMax(1024, int(_identityMap.size()) * 2);
+	}
+}
@@ -18,17 +18,86 @@
 #pragma once
 
 #include <QString>
+#include <QStringList>
 #include <QVariant>
+#include <QList>
+#include <QBitArray>
+#include <QSet>
+#include <QHash>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QWeakPointer>
 
 namespace cg
 {
+	// The sorted keys of a class, shared by every object of the class that has the same
+	// keys so each object only stores its values. Shapes never change once created and can
+	// be read from any thread, adding a key to an object moves it to another shape.
+	class ParseObjectShape
+	{
+	public:
+		ParseObjectShape(const QStringList& keys);
+
+		int slot(const QString& key) const;
+		bool matches(const QVariantMap& map) const;
+
+		static QSharedPointer<const ParseObjectShape> find(const QString& className, const QVariantMap& map);
+		static QSharedPointer<const ParseObjectShape> find(const QString& className, const QStringList& keys);
+		static QSharedPointer<const ParseObjectShape> withKey(const QString& className, const QSharedPointer<const ParseObjectShape>& pShape, const QString& key);
+
+		const QStringList keys;
+
+	private:
+		QHash<QString, int> _slotIndex;
+		mutable QHash<QString, QSharedPointer<const ParseObjectShape>> _transitions;
+
+		static QMutex _mutex;
+		static QHash<QString, QList<QSharedPointer<const ParseObjectShape>>> _shapes;
+	};
+
 	class ParseObjectImpl
 	{
 	public:
 		ParseObjectImpl(const QString& className);
 
+		QVariant value(const QString& key) const;
+		bool contains(const QString& key) const;
+		QStringList keys() const;
+		QVariantMap toMap() const;
+		bool isEmpty() const;
+
+		void setValue(const QString& key, const QVariant& value);
+		bool isDirty() const;
+		bool isDirty(const QString& key) const;
+		void revert();
+		void revert(const QString& key);
+		void clearDirtyState();
+		void mergeValues(const QVariantMap& map);
+		void setServerValues(const QVariantMap& map);
+
+		static QSharedPointer<ParseObjectImpl> identity(const QString& className, const QString& objectId);
+
 		QString className;
-		QVariantMap valueMap, savedValueMap;
+
+		// keys changed since the last clearDirtyState() and the values they had
+		// at that time, keys that did not exist then are not in savedValueMap
+		QSet<QString> dirtyKeys;
+		QVariantMap savedValueMap;
+
+	private:
+		void insert(const QString& key, const QVariant& value);
+		void remove(const QString& key);
+		void setShape(const QSharedPointer<const ParseObjectShape>& pShape);
+
+		static void pruneIdentityMap();
+
+		// values by slot of the shape, a slot without a value has its present bit cleared
+		QSharedPointer<const ParseObjectShape> _pShape;
+		QList<QVariant> _values;
+		QBitArray _present;
+
+		static QHash<QString, QWeakPointer<ParseObjectImpl>> _identityMap;
+		static int _identityMapPruneSize;
 	};
 }
 
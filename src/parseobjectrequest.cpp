@@ -14,17 +14,21 @@
 * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 #include "parseobjectrequest.h"
+#include "parsequeryrequest.h"
 #include "parseobject.h"
 #include "parseuser.h"
 #include "parserequest.h"
 #include "parsereply.h"
 #include "parsefile.h"
 #include "parseconvert.h"
+#include "parsesaveplan.h"
+#include "parseclient.h"
+#include "parsejsonwriter.h"
 
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
-#include <QEventLoop>
+#include <QTimer>
 
 namespace cg
 {
@@ -32,6 +36,9 @@ namespace cg
 
     ParseObjectRequest::ParseObjectRequest()
     {
+        _pCoalescingTimer = new QTimer(this);
+        _pCoalescingTimer->setSingleShot(true);
+        connect(_pCoalescingTimer, &QTimer::timeout, this, &ParseObjectRequest::flushCoalescedRequests);
     }
 
     ParseObjectRequest::~ParseObjectRequest()
@@ -110,59 +117,78 @@ namespace cg
        return path;
     }
 
-    void ParseObjectRequest::saveChildrenIfNeeded(const ParseObject& object)
+    // aborting the reply of the save aborts the saves of the children
+    void ParseObjectRequest::saveChildrenIfNeeded(ParseReply* pReply, const QList<ParseObject>& objects, const std::function<void()>& sendRequest, QNetworkAccessManager* pNam)
     {
-        _objectsBeingSaved.insert(object);
-
-        QList<ParseFile> files;
-        QList<ParseObject> objects;
-        collectDirtyChildren(object, files, objects);
-
-        QList<ParseFile> filesToSave;
-        QList<ParseObject> objectsToSave;
+        for (auto & object : objects)
+            _objectsBeingSaved.insert(object);
 
-        // prevent infinite recursion
-        for (auto & dirtyObject : objects)
+        ParseSavePlan *pPlan = new ParseSavePlan(objects, _objectsBeingSaved, pNam);
+        if (pPlan->isEmpty())
         {
-            if (!_objectsBeingSaved.contains(dirtyObject) && dirtyObject.className() != "_User")
-            {
-                _objectsBeingSaved.insert(dirtyObject);
-                objectsToSave.append(dirtyObject);
-            }
+            delete pPlan;
+            sendRequest();
+            return;
         }
 
-        _objectObjectsMap.insert(object, objectsToSave);
+        // prevent other saves from saving the same children
+        for (auto & child : pPlan->children())
+            _objectsBeingSaved.insert(child);
 
-        for (auto & file : filesToSave)
+        connect(pPlan, &ParseSavePlan::finished, this, [pPlan, sendRequest]()
         {
-            QEventLoop loop;
-            ParseReply *pFileReply = file.save();
-            connect(pFileReply, &ParseReply::finished, &loop, &QEventLoop::quit);
-            loop.exec();
-        }
+            sendRequest();
+            pPlan->deleteLater();
+        });
 
-        for (auto & object : objectsToSave)
+        // the objects are not written when a child could not be saved, the reply gets its error instead
+        QPointer<ParseReply> pFailedReply = pReply;
+        connect(pPlan, &ParseSavePlan::failed, this, [this, pPlan, objects, pFailedReply](int status, const QByteArray& data)
         {
-            QEventLoop loop;
-            ParseReply *pObjectReply = object.save();
-            connect(pObjectReply, &ParseReply::finished, &loop, &QEventLoop::quit);
-            loop.exec();
-        }
+            for (auto & object : objects)
+                _objectsBeingSaved.remove(object);
+            for (auto & child : pPlan->children())
+                _objectsBeingSaved.remove(child);
+
+            if (pFailedReply)
+                pFailedReply->finish(status, data);
+
+            pPlan->deleteLater();
+        });
+
+        connect(pReply, &ParseReply::aborted, pPlan, [this, pPlan, objects]()
+        {
+            for (auto & object : objects)
+                _objectsBeingSaved.remove(object);
+            for (auto & child : pPlan->children())
+                _objectsBeingSaved.remove(child);
+
+            pPlan->abort();
+        });
+
+        pPlan->start();
     }
 
-    ParseReply* ParseObjectRequest::createObject(const ParseObject& object, QNetworkAccessManager* pNam)
+    ParseRequest ParseObjectRequest::createRequest(const ParseObject& object)
     {
-        saveChildrenIfNeeded(object);
-
-        QJsonObject jsonObject = ParseConvert::toJsonObject(object.toMap());
-        QJsonDocument doc(jsonObject);
-        QByteArray content = doc.toJson(QJsonDocument::Compact);
+        QByteArray content = ParseConvert::toJson(object.toMap());
 
-        ParseRequest request(ParseRequest::PostHttpMethod, classPath(object.className()), content);
+        return ParseRequest(ParseRequest::PostHttpMethod, classPath(object.className()), content);
+    }
 
-        ParseReply *pReply = new ParseReply(request, object.className(), pNam);
+    ParseReply* ParseObjectRequest::createObject(const ParseObject& object, QNetworkAccessManager* pNam)
+    {
+        QPointer<ParseReply> pReply = new ParseReply(object.className());
         connect(pReply, &ParseReply::preFinished, this, &ParseObjectRequest::privateCreateObjectFinished);
         _replyObjectMap.insert(pReply, object);
+
+        // the request is built once the children are saved so that it points to their objectIds
+        saveChildrenIfNeeded(pReply, QList<ParseObject>() << object, [this, pReply, object, pNam]()
+        {
+            if (pReply && !pReply->isAborted())
+                sendObjectRequest(pReply, createRequest(object), pNam);
+        }, pNam);
+
         return pReply;
     }
 
@@ -176,18 +202,13 @@ namespace cg
 
         if (!pReply->isError() && !object.isNull())
         {
-            QJsonDocument doc = QJsonDocument::fromJson(pReply->data());
+            const QJsonDocument &doc = pReply->document();
             if (doc.isObject())
             {
-                object.setValues(ParseConvert::toVariantMap(doc.object()));
-                object.clearDirtyState();
+                object.setServerValues(ParseConvert::toVariantMap(doc.object()));
             }
-        }
 
-        QList<ParseObject> savedObjects = _objectObjectsMap.take(object);
-        for (auto & savedObject : savedObjects)
-        {
-            _objectsBeingSaved.remove(savedObject);
+            clearQueryCache(QList<ParseObject>() << object);
         }
 
         _objectsBeingSaved.remove(object);
@@ -212,11 +233,10 @@ namespace cg
 
         if (!pReply->isError() && !object.isNull())
         {
-            QJsonDocument doc = QJsonDocument::fromJson(pReply->data());
+            const QJsonDocument &doc = pReply->document();
             if (doc.isObject())
             {
-                object.setValues(ParseConvert::toVariantMap(doc.object()));
-                object.clearDirtyState();
+                object.setServerValues(ParseConvert::toVariantMap(doc.object()));
             }
         }
     }
@@ -249,6 +269,24 @@ namespace cg
        return modifiedMap;
     }
 
+    // an update only sends the keys that have changed since the object was last saved or fetched
+    QVariantMap ParseObjectRequest::updateValues(const ParseObject& object)
+    {
+        QVariantMap map;
+
+        for (auto& key : object.dirtyKeys())
+            map.insert(key, object.value(key));
+
+        return removeReadOnlyValues(object.className(), map);
+    }
+
+    ParseRequest ParseObjectRequest::updateRequest(const ParseObject& object)
+    {
+        QByteArray content = ParseConvert::toJson(updateValues(object));
+
+        return ParseRequest(ParseRequest::PutHttpMethod, classPath(object.className()) + "/" + object.objectId(), content);
+    }
+
     ParseReply* ParseObjectRequest::updateObject(const ParseObject& object, QNetworkAccessManager* pNam)
     {
         if (object.isNull() || object.objectId().isEmpty())
@@ -256,18 +294,16 @@ namespace cg
             return new ParseReply(ParseError::UnknownError);
         }
 
-        saveChildrenIfNeeded(object);
-
-        QVariantMap map = removeReadOnlyValues(object.className(), object.toMap());
-
-        QJsonObject jsonObject = ParseConvert::toJsonObject(map);
-        QJsonDocument doc(jsonObject);
-        QByteArray content = doc.toJson(QJsonDocument::Compact);
-
-        ParseRequest request(ParseRequest::PutHttpMethod, classPath(object.className()) + "/" + object.objectId(), content);
-        ParseReply *pReply = new ParseReply(request, object.className(), pNam);
+        QPointer<ParseReply> pReply = new ParseReply(object.className());
         connect(pReply, &ParseReply::preFinished, this, &ParseObjectRequest::privateUpdateObjectFinished);
         _replyObjectMap.insert(pReply, object);
+
+        saveChildrenIfNeeded(pReply, QList<ParseObject>() << object, [this, pReply, object, pNam]()
+        {
+            if (pReply && !pReply->isAborted())
+                sendObjectRequest(pReply, updateRequest(object), pNam);
+        }, pNam);
+
         return pReply;
     }
 
@@ -281,18 +317,13 @@ namespace cg
 
         if (!pReply->isError() && !object.isNull())
         {
-            QJsonDocument doc = QJsonDocument::fromJson(pReply->data());
+            const QJsonDocument &doc = pReply->document();
             if (doc.isObject())
             {
-                object.setValues(ParseConvert::toVariantMap(doc.object()));
-                object.clearDirtyState();
+                object.setServerValues(ParseConvert::toVariantMap(doc.object()));
             }
-        }
 
-        QList<ParseObject> savedObjects = _objectObjectsMap.take(object);
-        for (auto & savedObject : savedObjects)
-        {
-            _objectsBeingSaved.remove(savedObject);
+            clearQueryCache(QList<ParseObject>() << object);
         }
 
         _objectsBeingSaved.remove(object);
@@ -306,7 +337,54 @@ namespace cg
         }
 
         ParseRequest request(ParseRequest::DeleteHttpMethod, classPath(object.className()) + "/" + object.objectId());
-        return new ParseReply(request, object.className(), pNam);
+        ParseReply *pReply = new ParseReply(object.className());
+        connect(pReply, &ParseReply::preFinished, this, [pReply, object]()
+        {
+            if (!pReply->isError())
+                clearQueryCache(QList<ParseObject>() << object);
+        });
+
+        sendObjectRequest(pReply, request, pNam);
+        return pReply;
+    }
+
+    ParseRequest ParseObjectRequest::saveAllRequest(const QList<ParseObject>& objects)
+    {
+        // written straight into one buffer, keys in the order QJsonDocument would sort them
+        ParseJsonWriter writer(objects.size() * 256);
+        writer.append("{\"requests\":[");
+
+        for (int i = 0; i < objects.size(); i++)
+        {
+            const ParseObject& object = objects.at(i);
+            QString pathStr = classPath(object.className());
+
+            if (i > 0)
+                writer.append(',');
+
+            writer.append("{\"body\":");
+
+            if (object.objectId().isEmpty())
+            {
+                writer.writeMap(object.toMap());
+                writer.append(",\"method\":\"POST\",\"path\":");
+                writer.writeString(pathStr);
+            }
+            else
+            {
+                writer.writeMap(updateValues(object));
+                writer.append(",\"method\":\"PUT\",\"path\":");
+                writer.writeString(pathStr + "/" + object.objectId());
+            }
+
+            writer.append('}');
+        }
+
+        writer.append("]}");
+
+        ParseRequest request(ParseRequest::PostHttpMethod, "/batch", writer.data());
+        request.setPriority(ParseRequest::BulkPriority);
+        return request;
     }
 
     ParseReply* ParseObjectRequest::saveAll(const QList<ParseObject>& objects, QNetworkAccessManager* pNam)
@@ -316,40 +394,56 @@ namespace cg
             return new ParseReply(ParseError::UnknownError);
         }
 
-        QJsonArray requestsArray;
+        QPointer<ParseReply> pReply = new ParseReply(QString());
 
-        for (auto & object : objects)
+        // objects of batches that were never sent are not left marked as being saved
+        connect(pReply, &ParseReply::aborted, this, [this, objects]()
         {
-            saveChildrenIfNeeded(object);
+            for (auto & object : objects)
+                _objectsBeingSaved.remove(object);
+        });
 
-            QJsonObject requestObject;
-            QString pathStr = classPath(object.className());
+        saveChildrenIfNeeded(pReply, objects, [this, pReply, objects, pNam]()
+        {
+            if (!pReply || pReply->isAborted())
+                return;
 
-            if (object.objectId().isEmpty())
+            sendBatches(pReply, objects.size(), [this, objects, pNam](int from, int count)
             {
-                QString apiPath = pathStr;
-                requestObject.insert("method", "POST");
-                requestObject.insert("path", apiPath);
-            }
-            else
-            {
-                QString apiPath = pathStr + "/" + object.objectId();
-                requestObject.insert("method", "PUT");
-                requestObject.insert("path", apiPath);
-            }
+                return saveObjects(objects.mid(from, count), pNam);
+            });
+        }, pNam);
 
-            QJsonObject bodyObject = ParseConvert::toJsonObject(object.toMap());
-            requestObject.insert("body", bodyObject);
-            requestsArray.append(requestObject);
+        return pReply;
+    }
+
+    // splits a long list of batch operations into /batch requests and completes pReply with the merged results
+    void ParseObjectRequest::sendBatches(ParseReply* pReply, int size, const ParseBatchPipeline::SendChunk& sendChunk)
+    {
+        QPointer<ParseReply> pAggregateReply = pReply;
+        ParseBatchPipeline *pPipeline = new ParseBatchPipeline(size, sendChunk, this);
+
+        if (pReply)
+        {
+            connect(pPipeline, &ParseBatchPipeline::progress, pReply, &ParseReply::progress);
+            connect(pReply, &ParseReply::aborted, pPipeline, &ParseBatchPipeline::abort);
         }
 
-        QJsonObject contentObject;
-        contentObject.insert("requests", requestsArray);
-        QJsonDocument doc(contentObject);
-        QByteArray content = doc.toJson(QJsonDocument::Compact);
+        connect(pPipeline, &ParseBatchPipeline::finished, this, [pPipeline, pAggregateReply](int status, const QByteArray& data)
+        {
+            if (pAggregateReply)
+                pAggregateReply->finish(status, data);
+
+            pPipeline->deleteLater();
+        });
 
-        ParseRequest request(ParseRequest::PostHttpMethod, "/batch", content);
-        ParseReply *pReply = new ParseReply(request, pNam);
+        pPipeline->start();
+    }
+
+    // saves one level of a ParseSavePlan, the children have already been saved
+    ParseReply* ParseObjectRequest::saveObjects(const QList<ParseObject>& objects, QNetworkAccessManager* pNam)
+    {
+        ParseReply *pReply = new ParseReply(saveAllRequest(objects), pNam);
         connect(pReply, &ParseReply::preFinished, this, &ParseObjectRequest::privateSaveAllFinished);
         _replyObjectListMap.insert(pReply, objects);
         return pReply;
@@ -362,26 +456,56 @@ namespace cg
             return;
 
         QList<ParseObject> objects = _replyObjectListMap.take(pReply);
+        QList<ParseObject> savedObjects;
 
         if (!pReply->isError())
         {
-            QJsonDocument doc = QJsonDocument::fromJson(pReply->data());
+            const QJsonDocument &doc = pReply->document();
             if (doc.isArray())
             {
                 QJsonArray resultsArray = doc.array();
-                for (int i = 0; i < resultsArray.size(); i++)
+                for (int i = 0; i < resultsArray.size() && i < objects.size(); i++)
                 {
                     QJsonObject arrayObject = resultsArray.at(i).toObject();
                     if (arrayObject.contains("success"))
                     {
                         QJsonObject successObject = arrayObject.value("success").toObject();
                         ParseObject object = objects.at(i);
-                        object.setValues(ParseConvert::toVariantMap(successObject));
-                        object.clearDirtyState();
+                        object.setServerValues(ParseConvert::toVariantMap(successObject));
+                        savedObjects.append(object);
                     }
                 }
             }
         }
+
+        clearQueryCache(savedObjects);
+
+        for (auto & object : objects)
+            _objectsBeingSaved.remove(object);
+    }
+
+    ParseRequest ParseObjectRequest::deleteAllRequest(const QList<ParseObject>& objects)
+    {
+        ParseJsonWriter writer(objects.size() * 64);
+        writer.append("{\"requests\":[");
+
+        for (int i = 0; i < objects.size(); i++)
+        {
+            const ParseObject& object = objects.at(i);
+
+            if (i > 0)
+                writer.append(',');
+
+            writer.append("{\"method\":\"DELETE\",\"path\":");
+            writer.writeString(classPath(object.className()) + "/" + object.objectId());
+            writer.append('}');
+        }
+
+        writer.append("]}");
+
+        ParseRequest request(ParseRequest::PostHttpMethod, "/batch", writer.data());
+        request.setPriority(ParseRequest::BulkPriority);
+        return request;
     }
 
     ParseReply* ParseObjectRequest::deleteAll(const QList<ParseObject>& objects, QNetworkAccessManager* pNam)
@@ -391,24 +515,192 @@ namespace cg
             return new ParseReply(ParseError::UnknownError);
         }
 
-        QJsonArray requestsArray;
+        ParseReply *pReply = new ParseReply(QString());
+
+        sendBatches(pReply, objects.size(), [this, objects, pNam](int from, int count)
+        {
+            QList<ParseObject> chunk = objects.mid(from, count);
+            ParseReply *pChunkReply = new ParseReply(deleteAllRequest(chunk), pNam);
+            connect(pChunkReply, &ParseReply::preFinished, this, [pChunkReply, chunk]()
+            {
+                if (!pChunkReply->isError())
+                    clearQueryCache(chunk);
+            });
+
+            return pChunkReply;
+        });
 
+        return pReply;
+    }
+
+    // cached query results of the classes of objects that were written are out of date
+    void ParseObjectRequest::clearQueryCache(const QList<ParseObject>& objects)
+    {
+        QSet<QString> classNames;
         for (auto & object : objects)
+            classNames.insert(object.className());
+
+        for (auto & className : classNames)
+            ParseQueryRequest::get()->clearCache(className);
+    }
+
+    // creates, updates and deletes of single objects go through here so they can be coalesced into /batch requests
+    void ParseObjectRequest::sendObjectRequest(ParseReply* pReply, const ParseRequest& request, QNetworkAccessManager* pNam)
+    {
+        if (!ParseClient::get()->isCoalescingEnabled())
         {
-            QString pathStr = classPath(object.className());
-            QString apiPath = pathStr + "/" + object.objectId();
-            QJsonObject requestObject;
-            requestObject.insert("method", "DELETE");
-            requestObject.insert("path", apiPath);
-            requestsArray.append(requestObject);
+            pReply->sendRequest(request, pNam);
+            return;
         }
 
-        QJsonObject contentObject;
-        contentObject.insert("requests", requestsArray);
-        QJsonDocument doc(contentObject);
-        QByteArray content = doc.toJson(QJsonDocument::Compact);
+        _coalescedRequests.append({ pReply, request, pNam });
+
+        if (_coalescedRequests.size() >= ParseClient::get()->batchSize())
+            flushCoalescedRequests();
+        else if (!_pCoalescingTimer->isActive())
+            _pCoalescingTimer->start(ParseClient::get()->coalescingInterval());
+    }
+
+    QString ParseObjectRequest::batchMethod(ParseRequest::HttpMethod method)
+    {
+        switch (method)
+        {
+        case ParseRequest::GetHttpMethod:
+            return "GET";
+        case ParseRequest::PutHttpMethod:
+            return "PUT";
+        case ParseRequest::PostHttpMethod:
+            return "POST";
+        case ParseRequest::DeleteHttpMethod:
+            return "DELETE";
+        default:
+            break;
+        }
+
+        return QString();
+    }
+
+    void ParseObjectRequest::flushCoalescedRequests()
+    {
+        _pCoalescingTimer->stop();
+
+        QList<CoalescedRequest> requests;
+        requests.swap(_coalescedRequests);
+
+        const QByteArray sessionTokenHeader = "X-Parse-Session-Token";
+        int batchSize = ParseClient::get()->batchSize();
+        int i = 0;
+
+        while (i < requests.size())
+        {
+            // requests in one batch share the network access manager and session token
+            QNetworkAccessManager *pNam = requests.at(i).pNam;
+            QByteArray sessionToken = requests.at(i).request.header(sessionTokenHeader);
+            QList<CoalescedRequest> batch;
+
+            while (i < requests.size() && batch.size() < batchSize &&
+                requests.at(i).pNam == pNam &&
+                requests.at(i).request.header(sessionTokenHeader) == sessionToken)
+            {
+                if (requests.at(i).pReply && !requests.at(i).pReply->isAborted())
+                    batch.append(requests.at(i));
+                i++;
+            }
+
+            if (batch.isEmpty())
+                continue;
+
+            if (batch.size() == 1)
+            {
+                batch.first().pReply->sendRequest(batch.first().request, pNam);
+                continue;
+            }
+
+            // the bodies are already JSON, they are copied in without parsing them again
+            ParseJsonWriter writer;
+            writer.append("{\"requests\":[");
+
+            for (int j = 0; j < batch.size(); j++)
+            {
+                const ParseRequest& coalescedRequest = batch.at(j).request;
+
+                if (j > 0)
+                    writer.append(',');
+
+                writer.append('{');
+                if (!coalescedRequest.content().isEmpty())
+                {
+                    writer.append("\"body\":");
+                    writer.append(coalescedRequest.content());
+                    writer.append(',');
+                }
+
+                writer.append("\"method\":");
+                writer.writeString(batchMethod(coalescedRequest.httpMethod()));
+                writer.append(",\"path\":");
+                writer.writeString(coalescedRequest.apiRoute());
+                writer.append('}');
+            }
+
+            writer.append("]}");
+
+            ParseRequest request(ParseRequest::PostHttpMethod, "/batch", writer.data());
+            if (sessionToken.isEmpty())
+                request.removeHeader(sessionTokenHeader);
+            else
+                request.setHeader(sessionTokenHeader, sessionToken);
+
+            ParseReply *pBatchReply = new ParseReply(request, pNam);
+            connect(pBatchReply, &ParseReply::finished, this, &ParseObjectRequest::privateCoalescedBatchFinished);
+            _batchRequestsMap.insert(pBatchReply, batch);
+        }
+    }
+
+    // completes each caller's reply from its slot in the /batch results
+    void ParseObjectRequest::privateCoalescedBatchFinished()
+    {
+        ParseReply *pBatchReply = qobject_cast<ParseReply*>(sender());
+        if (!pBatchReply)
+            return;
+
+        QList<CoalescedRequest> batch = _batchRequestsMap.take(pBatchReply);
+
+        QJsonArray resultsArray;
+        if (!pBatchReply->isError())
+        {
+            const QJsonDocument &doc = pBatchReply->document();
+            if (doc.isArray())
+                resultsArray = doc.array();
+        }
+
+        for (int i = 0; i < batch.size(); i++)
+        {
+            ParseReply *pReply = batch.at(i).pReply;
+            if (!pReply)
+                continue;
+
+            if (i < resultsArray.size())
+            {
+                QJsonObject resultObject = resultsArray.at(i).toObject();
+                if (resultObject.contains("success"))
+                {
+                    int status = batch.at(i).request.httpMethod() == ParseRequest::PostHttpMethod ? 201 : 200;
+                    QJsonDocument successDoc(resultObject.value("success").toObject());
+                    pReply->finish(status, successDoc.toJson(QJsonDocument::Compact));
+                }
+                else
+                {
+                    QJsonDocument errorDoc(resultObject.value("error").toObject());
+                    pReply->finish(400, errorDoc.toJson(QJsonDocument::Compact));
+                }
+            }
+            else
+            {
+                // the batch itself failed so every operation gets its status and error
+                pReply->finish(pBatchReply->statusCode(), pBatchReply->data());
+            }
+        }
 
-        ParseRequest request(ParseRequest::PostHttpMethod, "/batch", content);
-        return new ParseReply(request, pNam);
+        pBatchReply->deleteLater();
     }
 }
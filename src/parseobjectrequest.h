@@ -19,13 +19,18 @@
 
 #include "parse.h"
 #include "parseobjectpointer.h"
+#include "parserequest.h"
+#include "parsebatchpipeline.h"
 
 #include <QObject>
 #include <QMap>
 #include <QSet>
+#include <QPointer>
+#include <functional>
 
 class QNetworkReply;
 class QNetworkAccessManager;
+class QTimer;
 
 namespace cg
 {
@@ -56,21 +61,46 @@ namespace cg
         void privateFetchObjectFinished();
         void privateUpdateObjectFinished();
         void privateSaveAllFinished();
+        void flushCoalescedRequests();
+        void privateCoalescedBatchFinished();
 
     private:
-        void saveChildrenIfNeeded(const ParseObject& object);
+        friend class ParseSavePlan;
+
+        // a single object request waiting to be sent in a coalesced /batch
+        struct CoalescedRequest
+        {
+            QPointer<ParseReply> pReply;
+            ParseRequest request;
+            QNetworkAccessManager* pNam;
+        };
+
+        void sendObjectRequest(ParseReply* pReply, const ParseRequest& request, QNetworkAccessManager* pNam);
+        void sendBatches(ParseReply* pReply, int size, const ParseBatchPipeline::SendChunk& sendChunk);
+
+        void saveChildrenIfNeeded(ParseReply* pReply, const QList<ParseObject>& objects, const std::function<void()>& sendRequest, QNetworkAccessManager* pNam);
+        ParseReply* saveObjects(const QList<ParseObject>& objects, QNetworkAccessManager* pNam);
         bool collectDirtyChildren(const ParseObject& object, QList<ParseFile> &files, QList<ParseObject> &objects);
         void collectDirtyChildren(const QVariantMap &map, QList<ParseFile> &files, QList<ParseObject> &objects);
         void collectDirtyChildren(const QVariantList &list, QList<ParseFile> &files, QList<ParseObject> &objects);
+        static ParseRequest createRequest(const ParseObject& object);
+        static ParseRequest updateRequest(const ParseObject& object);
+        static ParseRequest saveAllRequest(const QList<ParseObject>& objects);
+        static ParseRequest deleteAllRequest(const QList<ParseObject>& objects);
         static QString classPath(const QString& className);
         static QVariantMap removeReadOnlyValues(const QString& className, const QVariantMap& map);
+        static QVariantMap updateValues(const ParseObject& object);
+        static QString batchMethod(ParseRequest::HttpMethod method);
+        static void clearQueryCache(const QList<ParseObject>& objects);
 
     private:
         static ParseObjectRequest* _instance;
-        QMap<ParseObject, QList<ParseObject>> _objectObjectsMap;
         QSet<ParseObject> _objectsBeingSaved;
         QMap<ParseReply*, QList<ParseObject>> _replyObjectListMap;
         QMap<ParseReply*, ParseObject> _replyObjectMap;
+        QList<CoalescedRequest> _coalescedRequests;
+        QMap<ParseReply*, QList<CoalescedRequest>> _batchRequestsMap;
+        QTimer *_pCoalescingTimer;
     };
 }
 
@@ -32,6 +32,9 @@ namespace cg
         , skip(0)
         , count(0)
         , countResult(0)
+        , cachePolicy(NetworkOnly)
+        , streamingEnabled(false)
+        , priority(ParseRequest::NormalPriority)
     {
     }
 
@@ -41,6 +44,9 @@ namespace cg
         , skip(0)
         , count(0)
         , countResult(0)
+        , cachePolicy(NetworkOnly)
+        , streamingEnabled(false)
+        , priority(ParseRequest::NormalPriority)
     {
     }
 
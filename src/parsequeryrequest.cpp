@@ -16,6 +16,12 @@
 #include "parsequeryrequest.h"
 #include "parserequest.h"
 #include "parsereply.h"
+#include "parseclient.h"
+#include "parsequerystream.h"
+#include "parsequeryscan.h"
+
+#include <QPointer>
+#include <QTimer>
 
 namespace cg
 {
@@ -51,12 +57,10 @@ namespace cg
 		urlQuery.setQuery(queryStr);
 
 		ParseRequest request(ParseRequest::GetHttpMethod, classPath(pQueryImpl->className));
+		request.setPriority(pQueryImpl->priority);
 		request.setUrlQuery(urlQuery);
 
-		ParseReply* pReply = new ParseReply(request, pQueryImpl->className, pNam);
-		connect(pReply, &ParseReply::preFinished, this, &ParseQueryRequest::getObjectFinished);
-		_replyMap.insert(pReply, pQueryImpl);
-		return pReply;
+		return sendQuery(pQueryImpl, request, pNam, &ParseQueryRequest::getObjectFinished);
 	}
 
 	void ParseQueryRequest::getObjectFinished()
@@ -67,15 +71,13 @@ namespace cg
 
 		auto pImpl = _replyMap.take(pReply);
 
-		if (!pReply->isError())
+		// share the objects the reply already decoded
+		if (pImpl && !pReply->isError())
 		{
-			QJsonDocument doc = QJsonDocument::fromJson(pReply->data());
-			if (doc.isObject())
-			{
-				QJsonObject obj = doc.object();
-				QJsonArray jsonArray = obj.value("results").toArray();
-				setResults(pImpl, jsonArray);
-			}
+			pImpl->results = pReply->objects<ParseObject>();
+
+			if (pImpl->cachePolicy == CacheThenNetwork)
+				emit pReply->resultsAvailable(pImpl->results);
 		}
 	}
 
@@ -89,12 +91,10 @@ namespace cg
 		pQueryImpl->results.clear();
 
 		ParseRequest request(ParseRequest::GetHttpMethod, classPath(pQueryImpl->className));
+		request.setPriority(pQueryImpl->priority);
 		request.setUrlQuery(urlQuery);
 
-		ParseReply* pReply = new ParseReply(request, pQueryImpl->className, pNam);
-		connect(pReply, &ParseReply::preFinished, this, &ParseQueryRequest::findObjectsFinished);
-		_replyMap.insert(pReply, pQueryImpl);
-		return pReply;
+		return sendQuery(pQueryImpl, request, pNam, &ParseQueryRequest::findObjectsFinished);
 	}
 
 	void ParseQueryRequest::findObjectsFinished()
@@ -105,15 +105,12 @@ namespace cg
 
 		auto pImpl = _replyMap.take(pReply);
 
-		if (!pReply->isError())
+		if (pImpl && !pReply->isError())
 		{
-			QJsonDocument doc = QJsonDocument::fromJson(pReply->data());
-			if (doc.isObject())
-			{
-				QJsonObject obj = doc.object();
-				QJsonArray jsonArray = obj.value("results").toArray();
-				setResults(pImpl, jsonArray);
-			}
+			pImpl->results = pReply->objects<ParseObject>();
+
+			if (pImpl->cachePolicy == CacheThenNetwork)
+				emit pReply->resultsAvailable(pImpl->results);
 		}
 	}
 
@@ -128,12 +125,10 @@ namespace cg
 		pQueryImpl->countResult = 0;
 
 		ParseRequest request(ParseRequest::GetHttpMethod, classPath(pQueryImpl->className));
+		request.setPriority(pQueryImpl->priority);
 		request.setUrlQuery(urlQuery);
 
-		ParseReply* pReply = new ParseReply(request, pQueryImpl->className, pNam);
-		connect(pReply, &ParseReply::preFinished, this, &ParseQueryRequest::countObjectsFinished);
-		_replyMap.insert(pReply, pQueryImpl);
-		return pReply;
+		return sendQuery(pQueryImpl, request, pNam, &ParseQueryRequest::countObjectsFinished);
 	}
 
 	void ParseQueryRequest::countObjectsFinished()
@@ -145,7 +140,213 @@ namespace cg
 		auto pQueryImpl = _replyMap.take(pReply);
 
 		if (pQueryImpl)
+		{
 			pQueryImpl->countResult = pReply->count();
+
+			if (pQueryImpl->cachePolicy == CacheThenNetwork && !pReply->isError())
+				emit pReply->resultsAvailable(pQueryImpl->results);
+		}
+	}
+
+	// the reply emits resultsAvailable() for every page and finishes with the total count once the last page is received
+	ParseReply* ParseQueryRequest::streamObjects(QSharedPointer<ParseQueryImpl> pQueryImpl, const QString& cursorKey, int pageSize, QNetworkAccessManager* pNam,
+		const std::function<void(const QList<ParseObject>&)>& callback)
+	{
+		if (!pQueryImpl || pQueryImpl->className.isEmpty() || cursorKey.isEmpty())
+		{
+			return new ParseReply(ParseError::UnknownError);
+		}
+
+		QList<ParseQueryStream*> partitions;
+		partitions.append(new ParseQueryStream(pQueryImpl, cursorKey, pageSize, pNam));
+
+		return startScan(new ParseQueryScan(partitions, 1, false), pQueryImpl->className, callback);
+	}
+
+	// splits the objects into partitions that are streamed concurrently by the first character of
+	// their objectId, which is one of 0-9, A-Z and a-z. Each partition matches a set of first characters
+	// rather than a range of objectIds, so the partitions do not depend on how the server collates
+	// strings; the first one also takes objectIds that start with any other character.
+	ParseReply* ParseQueryRequest::scanObjects(QSharedPointer<ParseQueryImpl> pQueryImpl, int partitionCount, int maxConcurrent, bool ordered,
+		int pageSize, QNetworkAccessManager* pNam, const std::function<void(const QList<ParseObject>&)>& callback)
+	{
+		if (!pQueryImpl || pQueryImpl->className.isEmpty())
+		{
+			return new ParseReply(ParseError::UnknownError);
+		}
+
+		static const QString objectIdCharacters = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+		partitionCount = qBound(1, partitionCount, int(objectIdCharacters.size()));
+
+		QList<ParseQueryStream*> partitions;
+		int size = int(objectIdCharacters.size());
+		int firstEnd = size / partitionCount;
+
+		for (int i = 0; i < partitionCount; i++)
+		{
+			ParseQueryStream* pPartition = new ParseQueryStream(pQueryImpl, Parse::ObjectIdKey, pageSize, pNam);
+
+			if (partitionCount > 1)
+			{
+				int begin = i * size / partitionCount;
+				int end = (i + 1) * size / partitionCount;
+
+				if (i == 0)
+					pPartition->setPattern("^[^" + objectIdCharacters.mid(firstEnd) + "]");
+				else
+					pPartition->setPattern("^[" + objectIdCharacters.mid(begin, end - begin) + "]");
+			}
+
+			partitions.append(pPartition);
+		}
+
+		return startScan(new ParseQueryScan(partitions, maxConcurrent, ordered), pQueryImpl->className, callback);
+	}
+
+	ParseReply* ParseQueryRequest::startScan(ParseQueryScan* pScan, const QString& className, const std::function<void(const QList<ParseObject>&)>& callback)
+	{
+		ParseReply* pReply = new ParseReply(className);
+		QPointer<ParseReply> pScanReply = pReply;
+
+		connect(pScan, &ParseQueryScan::resultsAvailable, pReply, &ParseReply::resultsAvailable);
+		if (callback)
+			connect(pScan, &ParseQueryScan::resultsAvailable, pReply, callback);
+
+		connect(pScan, &ParseQueryScan::finished, this, [pScan, pScanReply](int status, const QByteArray& data)
+		{
+			if (pScanReply)
+				pScanReply->finish(status, data);
+
+			pScan->deleteLater();
+		});
+
+		connect(pScan, &ParseQueryScan::failed, this, [pScan, pScanReply](int status, int error, const QString& message)
+		{
+			if (pScanReply)
+				pScanReply->fail(status, error, message);
+
+			pScan->deleteLater();
+		});
+
+		// deleting or aborting the reply stops the scan
+		connect(pReply, &QObject::destroyed, pScan, &QObject::deleteLater);
+		connect(pReply, &ParseReply::aborted, pScan, &QObject::deleteLater);
+
+		pScan->start();
+		return pReply;
+	}
+
+	// answers a query from the cache, the network or both depending on its cache policy
+	ParseReply* ParseQueryRequest::sendQuery(QSharedPointer<ParseQueryImpl> pQueryImpl, const ParseRequest& request, QNetworkAccessManager* pNam,
+		void (ParseQueryRequest::*finishedSlot)())
+	{
+		if (pQueryImpl->streamingEnabled)
+		{
+			// streamed results bypass the cache, they are delivered through resultsAvailable() as they arrive
+			ParseReply* pReply = new ParseReply(pQueryImpl->className);
+			connect(pReply, &ParseReply::preFinished, this, finishedSlot);
+			_replyMap.insert(pReply, pQueryImpl);
+
+			pReply->setStreamingEnabled(true);
+			pReply->sendRequest(request, pNam);
+			return pReply;
+		}
+
+		ParseCachePolicy policy = pQueryImpl->cachePolicy;
+		QString key = cacheKey(request);
+		QByteArray* pCachedData = policy != NetworkOnly ? _cache.object(key) : nullptr;
+
+		if (policy == CacheOnly && !pCachedData)
+		{
+			return new ParseReply(ParseError::CacheMiss);
+		}
+
+		ParseReply* pReply = new ParseReply(pQueryImpl->className);
+		connect(pReply, &ParseReply::preFinished, this, finishedSlot);
+		_replyMap.insert(pReply, pQueryImpl);
+
+		if (pCachedData && policy != NetworkElseCache)
+		{
+			QByteArray data = *pCachedData;
+
+			if (policy != CacheThenNetwork)
+			{
+				QTimer::singleShot(0, pReply, [pReply, data]() { pReply->decode(200, data); });
+				return pReply;
+			}
+
+			QTimer::singleShot(0, pReply, [this, pReply, pQueryImpl, data]() { cachedResultsAvailable(pReply, pQueryImpl, data); });
+		}
+
+		QPointer<ParseReply> pQueryReply = pReply;
+		ParseReply* pNetworkReply = new ParseReply(request, pQueryImpl->className, pNam);
+
+		// aborting or deleting the reply cancels the request behind it
+		connect(pReply, &ParseReply::aborted, pNetworkReply, &ParseReply::abort);
+		connect(pReply, &QObject::destroyed, pNetworkReply, &ParseReply::abort);
+
+		connect(pNetworkReply, &ParseReply::finished, this, [this, pNetworkReply, pQueryReply, key, policy]()
+		{
+			pNetworkReply->deleteLater();
+
+			bool succeeded = !pNetworkReply->isError() && pNetworkReply->statusCode() == 200;
+			if (succeeded)
+			{
+				_cache.setMaxCost(ParseClient::get()->queryCacheSize());
+				_cache.insert(key, new QByteArray(pNetworkReply->data()), pNetworkReply->constData().size());
+			}
+
+			if (!pQueryReply || pQueryReply->isAborted())
+				return;
+
+			QByteArray* pCachedData = !succeeded && policy == NetworkElseCache ? _cache.object(key) : nullptr;
+			if (pCachedData)
+				pQueryReply->decode(200, *pCachedData);
+			else
+				pQueryReply->finish(pNetworkReply);
+		});
+
+		return pReply;
+	}
+
+	// the first result set of CacheThenNetwork, the reply finishes when the network result arrives
+	void ParseQueryRequest::cachedResultsAvailable(ParseReply* pReply, QSharedPointer<ParseQueryImpl> pQueryImpl, const QByteArray& data)
+	{
+		QJsonDocument doc = QJsonDocument::fromJson(data);
+		if (!doc.isObject())
+			return;
+
+		QJsonObject obj = doc.object();
+		setResults(pQueryImpl, obj.value("results").toArray());
+
+		if (obj.contains("count"))
+			pQueryImpl->countResult = obj.value("count").toInt();
+
+		emit pReply->resultsAvailable(pQueryImpl->results);
+	}
+
+	QString ParseQueryRequest::cacheKey(const ParseRequest& request)
+	{
+		// results depend on the user's access so the session token is part of the key
+		return request.apiRoute() + "?" + request.urlQuery().toString(QUrl::FullyEncoded) + "#" + QString::fromUtf8(request.header("X-Parse-Session-Token"));
+	}
+
+	void ParseQueryRequest::clearCache()
+	{
+		_cache.clear();
+	}
+
+	// drops the cached results of every query on the class, whatever its constraints and session
+	void ParseQueryRequest::clearCache(const QString& className)
+	{
+		QString prefix = classPath(className) + "?";
+
+		const QList<QString> keys = _cache.keys();
+		for (auto & key : keys)
+		{
+			if (key.startsWith(prefix))
+				_cache.remove(key);
+		}
 	}
 
 	void ParseQueryRequest::setResults(QSharedPointer<ParseQueryImpl> pImpl, const QJsonArray& jsonArray)
@@ -164,10 +365,7 @@ namespace cg
 
 				if (!objectId.isEmpty())
 				{
-					ParseObject object = ParseObject::create(pImpl->className);
-					object.setValues(ParseConvert::toVariantMap(jsonObject));
-					object.clearDirtyState();
-					pImpl->results.append(object);
+					pImpl->results.append(ParseConvert::toObject(pImpl->className, jsonObject));
 				}
 			}
 		}
@@ -0,0 +1,138 @@
+/**
+* Copyright 2017 Charles Glancy (charles@glancyfamily.net)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+* files (the "Software"), to deal in the Software without restriction, including  without limitation the rights to use, copy,
+* modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+* is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+* WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "parsequeryscan.h"
+#include "parsequerystream.h"
+
+#include <QJsonDocument>
+#include <QJsonObject>
+
+namespace cg
+{
+    ParseQueryScan::ParseQueryScan(const QList<ParseQueryStream*>& partitions, int maxConcurrent, bool ordered)
+        : _partitions(partitions)
+        , _maxConcurrent(qMax(1, maxConcurrent))
+        , _nextPartition(0)
+        , _running(0)
+        , _emitPartition(0)
+        , _count(0)
+        , _ordered(ordered)
+        , _finished(false)
+    {
+        for (auto pPartition : _partitions)
+        {
+            pPartition->setParent(this);
+            connect(pPartition, &ParseQueryStream::resultsAvailable, this, &ParseQueryScan::partitionResultsAvailable);
+            connect(pPartition, &ParseQueryStream::finished, this, &ParseQueryScan::partitionFinished);
+            connect(pPartition, &ParseQueryStream::failed, this, &ParseQueryScan::partitionFailed);
+        }
+    }
+
+    ParseQueryScan::~ParseQueryScan()
+    {
+    }
+
+    void ParseQueryScan::start()
+    {
+        startNextPartitions();
+    }
+
+    void ParseQueryScan::startNextPartitions()
+    {
+        while (_nextPartition < _partitions.size() && _running < _maxConcurrent)
+        {
+            _running++;
+            _partitions.at(_nextPartition++)->start();
+        }
+    }
+
+    // the partitions still running or waiting are dropped, their pages in flight are deleted with them
+    void ParseQueryScan::stopPartitions()
+    {
+        for (auto pPartition : _partitions)
+        {
+            disconnect(pPartition, nullptr, this, nullptr);
+            pPartition->deleteLater();
+        }
+
+        _partitions.clear();
+        _heldResults.clear();
+    }
+
+    void ParseQueryScan::partitionResultsAvailable(const QList<cg::ParseObject>& objects)
+    {
+        if (_finished)
+            return;
+
+        int index = _partitions.indexOf(qobject_cast<ParseQueryStream*>(sender()));
+        if (index < 0)
+            return;
+
+        _count += objects.size();
+
+        if (!_ordered || index == _emitPartition)
+            emit resultsAvailable(objects);
+        else
+            _heldResults[index].append(objects);
+    }
+
+    void ParseQueryScan::partitionFinished()
+    {
+        if (_finished)
+            return;
+
+        // a partition only finishes once it has every row of its range, failures go to partitionFailed()
+        int index = _partitions.indexOf(qobject_cast<ParseQueryStream*>(sender()));
+        if (index < 0)
+            return;
+
+        _running--;
+        _finishedPartitions.insert(index);
+
+        if (_ordered)
+        {
+            while (_finishedPartitions.contains(_emitPartition))
+            {
+                _emitPartition++;
+
+                for (auto & objects : _heldResults.take(_emitPartition))
+                    emit resultsAvailable(objects);
+            }
+        }
+
+        if (_finishedPartitions.size() == _partitions.size())
+        {
+            _finished = true;
+
+            QJsonObject countObject;
+            countObject.insert("count", _count);
+            emit finished(200, QJsonDocument(countObject).toJson(QJsonDocument::Compact));
+            return;
+        }
+
+        startNextPartitions();
+    }
+
+    // one failed partition fails the whole scan and stops the others
+    void ParseQueryScan::partitionFailed(int status, int error, const QString& message)
+    {
+        if (_finished)
+            return;
+
+        _finished = true;
+        stopPartitions();
+        emit failed(status, error, message);
+    }
+}
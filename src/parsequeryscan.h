@@ -0,0 +1,67 @@
+/**
+* Copyright 2017 Charles Glancy (charles@glancyfamily.net)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+* files (the "Software"), to deal in the Software without restriction, including  without limitation the rights to use, copy,
+* modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+* is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+* WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#ifndef CGPARSE_PARSEQUERYSCAN_H
+#define CGPARSE_PARSEQUERYSCAN_H
+#pragma once
+
+#include "parse.h"
+#include "parseobject.h"
+
+#include <QObject>
+#include <QList>
+#include <QMap>
+#include <QSet>
+
+namespace cg
+{
+    class ParseQueryStream;
+
+    // Runs the streams of a partitioned query, at most maxConcurrent at a time, and merges
+    // their pages into one stream. When ordered, pages of a partition are held back until
+    // every partition before it has finished, so the merged stream follows partition order.
+    class ParseQueryScan : public QObject
+    {
+        Q_OBJECT
+    public:
+        ParseQueryScan(const QList<ParseQueryStream*>& partitions, int maxConcurrent, bool ordered);
+        ~ParseQueryScan();
+
+        void start();
+
+    signals:
+        void resultsAvailable(const QList<cg::ParseObject>& objects);
+        void finished(int status, const QByteArray& data);
+        void failed(int status, int error, const QString& message);
+
+    private slots:
+        void partitionResultsAvailable(const QList<cg::ParseObject>& objects);
+        void partitionFinished();
+        void partitionFailed(int status, int error, const QString& message);
+
+    private:
+        void startNextPartitions();
+        void stopPartitions();
+
+    private:
+        QList<ParseQueryStream*> _partitions;
+        int _maxConcurrent, _nextPartition, _running, _emitPartition, _count;
+        bool _ordered, _finished;
+        QSet<int> _finishedPartitions;
+        QMap<int, QList<QList<ParseObject>>> _heldResults;
+    };
+}
+
+#endif // CGPARSE_PARSEQUERYSCAN_H
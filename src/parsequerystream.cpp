@@ -0,0 +1,208 @@
+/**
+* Copyright 2017 Charles Glancy (charles@glancyfamily.net)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+* files (the "Software"), to deal in the Software without restriction, including  without limitation the rights to use, copy,
+* modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+* is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+* WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "parsequerystream.h"
+#include "parserequest.h"
+#include "parsereply.h"
+#include "parseconvert.h"
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+
+namespace cg
+{
+    ParseQueryStream::ParseQueryStream(QSharedPointer<ParseQueryImpl> pQueryImpl, const QString& cursorKey, int pageSize, QNetworkAccessManager* pNam)
+        : _className(pQueryImpl->className)
+        , _cursorKey(cursorKey)
+        , _whereObject(pQueryImpl->whereObject)
+        , _keysList(pQueryImpl->keysList)
+        , _includeList(pQueryImpl->includeList)
+        , _pageSize(qMax(1, pageSize))
+        , _count(0)
+        , _cursor(QJsonValue::Undefined)
+        , _priority(pQueryImpl->priority)
+        , _pNam(pNam)
+    {
+        // the cursor is read from the results so it must be returned
+        if (!_keysList.isEmpty() && !_keysList.contains(_cursorKey))
+            _keysList.append(_cursorKey);
+    }
+
+    ParseQueryStream::~ParseQueryStream()
+    {
+        if (_pPageReply)
+            _pPageReply->deleteLater();
+    }
+
+    // limits the stream to the rows whose cursor key matches the regular expression
+    void ParseQueryStream::setPattern(const QString& pattern)
+    {
+        _pattern = pattern;
+    }
+
+    void ParseQueryStream::start()
+    {
+        requestPage();
+    }
+
+    QUrlQuery ParseQueryStream::pageQuery() const
+    {
+        QJsonObject whereObject = _whereObject;
+
+        if (!_cursor.isUndefined() || !_pattern.isEmpty())
+        {
+            QJsonObject constraintObject;
+            if (!_pattern.isEmpty())
+                constraintObject.insert("$regex", _pattern);
+
+            if (!_cursor.isUndefined())
+                constraintObject.insert("$gt", _cursor);
+
+            // a constraint of the query on the cursor key is kept alongside the range rather than replaced
+            QJsonValue queryConstraint = whereObject.value(_cursorKey);
+            if (queryConstraint.isUndefined())
+            {
+                whereObject.insert(_cursorKey, constraintObject);
+            }
+            else
+            {
+                QJsonArray andArray = whereObject.value("$and").toArray();
+                andArray.append(QJsonObject{ { _cursorKey, queryConstraint } });
+                andArray.append(QJsonObject{ { _cursorKey, constraintObject } });
+                whereObject.remove(_cursorKey);
+                whereObject.insert("$and", andArray);
+            }
+        }
+
+        QUrlQuery urlQuery;
+
+        if (!whereObject.isEmpty())
+        {
+            QJsonDocument doc(whereObject);
+            urlQuery.addQueryItem("where", doc.toJson(QJsonDocument::Compact));
+        }
+
+        urlQuery.addQueryItem("order", _cursorKey);
+        urlQuery.addQueryItem("limit", QString::number(_pageSize));
+
+        if (!_keysList.isEmpty())
+            urlQuery.addQueryItem("keys", _keysList.join(','));
+
+        if (!_includeList.isEmpty())
+            urlQuery.addQueryItem("include", _includeList.join(','));
+
+        return urlQuery;
+    }
+
+    void ParseQueryStream::requestPage()
+    {
+        QString path = _className == Parse::UserClassNameKey ? QString("/users") : "/classes/" + _className;
+
+        ParseRequest request(ParseRequest::GetHttpMethod, path);
+        request.setUrlQuery(pageQuery());
+        request.setPriority(_priority);
+
+        _pPageReply = new ParseReply(request, _className, _pNam);
+        connect(_pPageReply, &ParseReply::finished, this, &ParseQueryStream::pageFinished);
+    }
+
+    void ParseQueryStream::pageFinished()
+    {
+        ParseReply *pReply = qobject_cast<ParseReply*>(sender());
+        if (!pReply)
+            return;
+
+        pReply->deleteLater();
+        _pPageReply = nullptr;
+
+        int status = pReply->statusCode();
+        QJsonValue results;
+        if (status == 200 && !pReply->isError())
+            results = pReply->document().object().value("results");
+
+        if (!results.isArray())
+        {
+            // the error of the response if it has one, 5xx responses are not errors to ParseReply
+            int error = pReply->errorCode();
+            QString message = pReply->errorMessage();
+
+            if (error == ParseError::NoError)
+            {
+                QJsonObject errorObject = pReply->document().object();
+                error = errorObject.value("code").toInt();
+                message = errorObject.value("error").toString();
+            }
+
+            if (error == ParseError::NoError)
+            {
+                error = status == 0 ? ParseError::ConnectionFailed : ParseError::UnknownError;
+                message = status == 0 ? QString("Connection failed") : QString("Unexpected response, status %1").arg(status);
+            }
+
+            emit failed(status, error, message);
+            return;
+        }
+
+        QJsonArray jsonArray = results.toArray();
+
+        // prefetch the next page before handing this one out
+        bool morePages = false;
+        if (jsonArray.size() >= _pageSize)
+        {
+            QJsonValue cursor = jsonArray.last().toObject().value(_cursorKey);
+
+            // createdAt and updatedAt come back as plain strings but are only compared as dates
+            if (cursor.isString() && (_cursorKey == Parse::CreatedAtKey || _cursorKey == Parse::UpdatedAtKey))
+            {
+                QJsonObject dateObject;
+                dateObject.insert(Parse::TypeKey, Parse::DateValue);
+                dateObject.insert(Parse::IsoDateKey, cursor);
+                cursor = dateObject;
+            }
+
+            if (!cursor.isUndefined() && !cursor.isNull())
+            {
+                _cursor = cursor;
+                morePages = true;
+                requestPage();
+            }
+        }
+
+        QList<ParseObject> objects;
+        objects.reserve(jsonArray.size());
+
+        for (auto jsonValue : jsonArray)
+        {
+            QJsonObject jsonObject = jsonValue.toObject();
+            if (!jsonObject.value(Parse::ObjectIdKey).toString().isEmpty())
+            {
+                objects.append(ParseConvert::toObject(_className, jsonObject));
+            }
+        }
+
+        _count += objects.size();
+
+        if (!objects.isEmpty())
+            emit resultsAvailable(objects);
+
+        if (!morePages)
+        {
+            QJsonObject countObject;
+            countObject.insert("count", _count);
+            emit finished(200, QJsonDocument(countObject).toJson(QJsonDocument::Compact));
+        }
+    }
+}
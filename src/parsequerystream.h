@@ -0,0 +1,77 @@
+/**
+* Copyright 2017 Charles Glancy (charles@glancyfamily.net)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+* files (the "Software"), to deal in the Software without restriction, including  without limitation the rights to use, copy,
+* modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+* is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+* WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#ifndef CGPARSE_PARSEQUERYSTREAM_H
+#define CGPARSE_PARSEQUERYSTREAM_H
+#pragma once
+
+#include "parse.h"
+#include "parseobject.h"
+#include "parsequeryimpl.h"
+
+#include <QObject>
+#include <QSharedPointer>
+#include <QPointer>
+#include <QJsonValue>
+#include <QUrlQuery>
+
+class QNetworkAccessManager;
+
+namespace cg
+{
+    class ParseReply;
+
+    // Pages through the results of a query ordered by a unique key. Each page asks for
+    // the objects whose key is greater than the last one received, so the server never
+    // scans skipped rows. The next page is requested before the current one is handed
+    // out, so it downloads while the caller processes the current page. A page that does
+    // not come back with results fails the stream, so a cut short stream is never mistaken
+    // for a complete one.
+    class ParseQueryStream : public QObject
+    {
+        Q_OBJECT
+    public:
+        ParseQueryStream(QSharedPointer<ParseQueryImpl> pQueryImpl, const QString& cursorKey, int pageSize, QNetworkAccessManager* pNam);
+        ~ParseQueryStream();
+
+        void setPattern(const QString& pattern);
+        void start();
+
+    signals:
+        void resultsAvailable(const QList<cg::ParseObject>& objects);
+        void finished(int status, const QByteArray& data);
+        void failed(int status, int error, const QString& message);
+
+    private slots:
+        void pageFinished();
+
+    private:
+        void requestPage();
+        QUrlQuery pageQuery() const;
+
+    private:
+        QString _className, _cursorKey;
+        QJsonObject _whereObject;
+        QStringList _keysList, _includeList;
+        int _pageSize, _count;
+        QJsonValue _cursor;
+        QString _pattern;
+        ParseRequest::Priority _priority;
+        QNetworkAccessManager* _pNam;
+        QPointer<ParseReply> _pPageReply;
+    };
+}
+
+#endif // CGPARSE_PARSEQUERYSTREAM_H
@@ -22,82 +22,249 @@
 #include "parseclient.h"
 #include "parsegraphql.h"
 #include "parseanalytics.h"
+#include "parsenetworkrequest.h"
+#include "parseresultstokenizer.h"
 
-#include <QNetworkReply>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QTimer>
+#include <QThreadPool>
+#include <QPromise>
+#include <QFutureWatcher>
 #include <QDebug>
 
+#include <chrono>
+
 namespace cg
 {
+    // a reply decoded on the thread pool, handed back to the reply's own thread
+    struct ParseReply::DecodedReply
+    {
+        DecodedReply() : documentParsed(false), objectsDecoded(false) {}
+
+        QJsonDocument document;
+        QList<ParseObject> objects;
+        bool documentParsed, objectsDecoded;
+    };
+
     //
     // ParseReply
     //
     ParseReply::ParseReply(int error)
-        : _pReply(nullptr)
+        : _pNetworkRequest(nullptr)
         , _statusCode(0)
         , _errorCode(error)
+        , _documentParsed(false)
+        , _objectsDecoded(false)
+        , _dataRetained(true)
+        , _streamingEnabled(false)
+        , _aborted(false)
+        , _deadline(QDeadlineTimer::Forever)
+        , _pDeadlineTimer(nullptr)
     {
         QTimer::singleShot(200, this, &ParseReply::finished);
     }
 
+    // constructs a reply whose request is sent later with sendRequest()
+    ParseReply::ParseReply(const QString& className)
+        : _pNetworkRequest(nullptr)
+        , _className(className)
+        , _statusCode(0)
+        , _errorCode(NoError)
+        , _documentParsed(false)
+        , _objectsDecoded(false)
+        , _dataRetained(true)
+        , _streamingEnabled(false)
+        , _aborted(false)
+        , _deadline(QDeadlineTimer::Forever)
+        , _pDeadlineTimer(nullptr)
+    {
+    }
+
     ParseReply::ParseReply(const ParseRequest& request, QNetworkAccessManager* pNam)
-        : _pReply(nullptr)
+        : _pNetworkRequest(nullptr)
         , _statusCode(0)
         , _errorCode(NoError)
+        , _documentParsed(false)
+        , _objectsDecoded(false)
+        , _dataRetained(true)
+        , _streamingEnabled(false)
+        , _aborted(false)
+        , _deadline(QDeadlineTimer::Forever)
+        , _pDeadlineTimer(nullptr)
     {
         sendRequest(request, pNam);
     }
 
     ParseReply::ParseReply(const ParseRequest &request, const QString& className, QNetworkAccessManager* pNam)
         : _className(className)
-        , _pReply(nullptr)
+        , _pNetworkRequest(nullptr)
         , _statusCode(0)
         , _errorCode(NoError)
+        , _documentParsed(false)
+        , _objectsDecoded(false)
+        , _dataRetained(true)
+        , _streamingEnabled(false)
+        , _aborted(false)
+        , _deadline(QDeadlineTimer::Forever)
+        , _pDeadlineTimer(nullptr)
     {
         sendRequest(request, pNam);
     }
 
     ParseReply::ParseReply(const ParseGraphQL& graphQL, QNetworkAccessManager* pNam)
-        : _pReply(nullptr)
+        : _pNetworkRequest(nullptr)
         , _statusCode(0)
         , _errorCode(NoError)
+        , _documentParsed(false)
+        , _objectsDecoded(false)
+        , _dataRetained(true)
+        , _streamingEnabled(false)
+        , _aborted(false)
+        , _deadline(QDeadlineTimer::Forever)
+        , _pDeadlineTimer(nullptr)
     {
         sendRequest(graphQL, pNam);
     }
 
     ParseReply::ParseReply(const ParseAnalytics& analytics, QNetworkAccessManager* pNam)
+        : _pNetworkRequest(nullptr)
+        , _statusCode(0)
+        , _errorCode(NoError)
+        , _documentParsed(false)
+        , _objectsDecoded(false)
+        , _dataRetained(true)
+        , _streamingEnabled(false)
+        , _aborted(false)
+        , _deadline(QDeadlineTimer::Forever)
+        , _pDeadlineTimer(nullptr)
     {
         sendRequest(analytics, pNam);
     }
 
+    // deleting a reply that is still waiting for its request cancels the request
+    // releasing the last hold on a request in flight aborts it, which reports back synchronously
     ParseReply::~ParseReply()
     {
+        if (_pNetworkRequest)
+        {
+            disconnect(_pNetworkRequest, nullptr, this, nullptr);
+            _pNetworkRequest->release();
+        }
     }
 
     void ParseReply::sendRequest(const ParseRequest &request, QNetworkAccessManager* pNam)
     {
-        if (request.isNull())
+        if (request.isNull() || _aborted)
             return;
 
-        _pReply = request.sendRequest(pNam);
-        if (_pReply)
-            connect(_pReply, &QNetworkReply::finished, this, &ParseReply::replyFinished);
+        setNetworkRequest(ParseNetworkRequest::send(request, pNam, _streamingEnabled));
     }
 
     void ParseReply::sendRequest(const ParseGraphQL& request, QNetworkAccessManager* pNam)
     {
-        _pReply = request.sendRequest(pNam);
-        if (_pReply)
-            connect(_pReply, &QNetworkReply::finished, this, &ParseReply::replyFinished);
+        if (_aborted)
+            return;
+
+        setNetworkRequest(ParseNetworkRequest::send(request, pNam));
     }
 
     void ParseReply::sendRequest(const ParseAnalytics& request, QNetworkAccessManager* pNam)
     {
-        _pReply = request.sendRequest(pNam);
-        if (_pReply)
-            connect(_pReply, &QNetworkReply::finished, this, &ParseReply::replyFinished);
+        if (_aborted)
+            return;
+
+        setNetworkRequest(ParseNetworkRequest::send(request, pNam));
+    }
+
+    // stops waiting for the request, the reply finishes with RequestAborted and anything
+    // sent on its behalf, like the batches of saveAll() or the children of a save, is cancelled
+    void ParseReply::abort()
+    {
+        cancel(ParseError::RequestAborted, "Request aborted");
+    }
+
+    bool ParseReply::isAborted() const
+    {
+        return _aborted;
+    }
+
+    QDeadlineTimer ParseReply::deadline() const
+    {
+        return _deadline;
+    }
+
+    // a reply that has not finished by the deadline is aborted with RequestTimeout, whether its
+    // request is still waiting for a slot, being retried or transferring
+    void ParseReply::setDeadline(const QDeadlineTimer& deadline)
+    {
+        _deadline = deadline;
+
+        if (!_pDeadlineTimer)
+        {
+            _pDeadlineTimer = new QTimer(this);
+            _pDeadlineTimer->setSingleShot(true);
+            _pDeadlineTimer->setTimerType(Qt::PreciseTimer);
+            connect(_pDeadlineTimer, &QTimer::timeout, this, [this]()
+            {
+                cancel(ParseError::RequestTimeout, "Request deadline exceeded");
+            });
+        }
+
+        _pDeadlineTimer->stop();
+
+        if (!_deadline.isForever() && !_aborted)
+            _pDeadlineTimer->start(std::chrono::ceil<std::chrono::milliseconds>(_deadline.remainingTimeAsDuration()));
+    }
+
+    // completes the reply without a response, aborted() tells the operations
+    // that sent requests for it to cancel them
+    void ParseReply::cancel(int error, const QString& message)
+    {
+        if (_aborted)
+            return;
+
+        _aborted = true;
+
+        if (_pNetworkRequest)
+        {
+            disconnect(_pNetworkRequest, nullptr, this, nullptr);
+            _pNetworkRequest->release();
+            _pNetworkRequest = nullptr;
+        }
+
+        if (_pDeadlineTimer)
+            _pDeadlineTimer->stop();
+
+        _pTokenizer.reset();
+        _statusCode = 0;
+        _errorCode = error;
+        _errorMessage = message;
+
+        emit aborted();
+        emit preFinished();
+        emit finished();
+    }
+
+    // finishes with an error the response does not carry itself, such as a stream that was cut short
+    void ParseReply::fail(int status, int error, const QString& message)
+    {
+        if (_aborted)
+            return;
+
+        if (_pDeadlineTimer)
+            _pDeadlineTimer->stop();
+
+        _pNetworkRequest = nullptr;
+        _pTokenizer.reset();
+        _statusCode = status;
+        _errorCode = error;
+        _errorMessage = message;
+
+        qWarning() << QString("Parse Error: %1 %2").arg(_errorCode).arg(_errorMessage);
+
+        emit preFinished();
+        emit finished();
     }
 
     bool ParseReply::isError() const 
@@ -115,16 +282,97 @@ namespace cg
         return _statusCode; 
     }
 
+    // once the data has been dropped this is the document serialized again, which is not kept
+    // and is not byte for byte what the server sent
     QByteArray ParseReply::data() const 
     { 
+        if (_data.isEmpty() && _documentParsed && !_document.isNull())
+            return _document.toJson(QJsonDocument::Compact);
+
         return _data; 
     }
 
+    // empty once the data has been dropped, see setDataRetained()
     const QByteArray & ParseReply::constData() const 
     { 
         return _data; 
     }
 
+    // the reply data parsed once, on first use
+    const QJsonDocument & ParseReply::document() const
+    {
+        if (!_documentParsed)
+        {
+            _document = QJsonDocument::fromJson(_data);
+            _documentParsed = true;
+
+            if (!_dataRetained && !_document.isNull())
+                _data.clear();
+        }
+
+        return _document;
+    }
+
+    bool ParseReply::isDataRetained() const
+    {
+        return _dataRetained;
+    }
+
+    // large replies can drop the raw data once it has been parsed so only the document is kept,
+    // constData() is then empty and data() has to serialize the document on every call
+    void ParseReply::setDataRetained(bool retained)
+    {
+        _dataRetained = retained;
+
+        if (!_dataRetained && _documentParsed && !_document.isNull())
+            _data.clear();
+    }
+
+    bool ParseReply::isStreamingEnabled() const
+    {
+        return _streamingEnabled;
+    }
+
+    // results are decoded and handed to resultsAvailable() while the response is still arriving,
+    // only the rest of the response is kept as the reply data. Must be set before sendRequest().
+    void ParseReply::setStreamingEnabled(bool enabled)
+    {
+        _streamingEnabled = enabled;
+    }
+
+    const QList<ParseObject> & ParseReply::resultObjects() const
+    {
+        if (!_objectsDecoded)
+        {
+            // the vectorized reader needs the data, it is only dropped once the document is parsed
+            if (ParseClient::get()->isVectorizedDecodingEnabled() && !_documentParsed)
+                _objects = ParseConvert::toObjects(_className, _data);
+            else
+                _objects = decodeResults(_className, document(), ParseClient::get()->isIdentityMapEnabled());
+
+            _objectsDecoded = true;
+        }
+
+        return _objects;
+    }
+
+    QList<ParseObject> ParseReply::decodeResults(const QString& className, const QJsonDocument& document, bool identityMapped)
+    {
+        QList<ParseObject> objects;
+
+        QJsonArray jsonArray = document.object().value("results").toArray();
+        objects.reserve(jsonArray.size());
+
+        for (auto jsonValue : jsonArray)
+        {
+            QJsonObject jsonObject = jsonValue.toObject();
+            if (!jsonObject.value(Parse::ObjectIdKey).toString().isEmpty())
+                objects.append(ParseConvert::toObject(className, jsonObject, identityMapped));
+        }
+
+        return objects;
+    }
+
     int ParseReply::errorCode() const 
     { 
         return _errorCode; 
@@ -135,20 +383,132 @@ namespace cg
         return _errorMessage; 
     }
 
-    void ParseReply::replyFinished()
+    void ParseReply::setNetworkRequest(ParseNetworkRequest* pNetworkRequest)
+    {
+        _pNetworkRequest = pNetworkRequest;
+        if (!_pNetworkRequest)
+            return;
+
+        if (_streamingEnabled)
+        {
+            _pTokenizer = QSharedPointer<ParseResultsTokenizer>::create();
+            connect(_pNetworkRequest, &ParseNetworkRequest::dataAvailable, this, &ParseReply::streamData);
+        }
+
+        connect(_pNetworkRequest, &ParseNetworkRequest::finished, this, &ParseReply::decode);
+    }
+
+    // large replies are parsed on the thread pool so the thread that owns the reply is not blocked
+    void ParseReply::decode(int status, const QByteArray &data)
+    {
+        int threshold = ParseClient::get()->decodeThreadThreshold();
+        if (_pTokenizer || threshold < 0 || data.size() < threshold)
+        {
+            finish(status, data);
+            return;
+        }
+
+        // identity mapped objects are shared with the owning thread, they are decoded there on first use,
+        // the worker decodes without the identity map and never reads ParseClient
+        bool decodeObjects = !ParseClient::get()->isIdentityMapEnabled();
+        bool vectorized = ParseClient::get()->isVectorizedDecodingEnabled();
+        QString className = _className;
+
+        auto pPromise = QSharedPointer<QPromise<DecodedReply>>::create();
+        auto pWatcher = new QFutureWatcher<DecodedReply>(this);
+
+        connect(pWatcher, &QFutureWatcherBase::finished, this, [this, pWatcher, status, data]()
+        {
+            pWatcher->deleteLater();
+
+            DecodedReply decoded = pWatcher->result();
+            finish(status, data, &decoded);
+        });
+
+        pWatcher->setFuture(pPromise->future());
+
+        QThreadPool::globalInstance()->start([pPromise, status, data, className, decodeObjects, vectorized]()
+        {
+            DecodedReply decoded;
+
+            // the vectorized reader decodes the results without a document, it is parsed later if asked for
+            if (decodeObjects && vectorized && !isError(status))
+            {
+                decoded.objects = ParseConvert::toObjects(className, data, false);
+                decoded.objectsDecoded = true;
+            }
+            else
+            {
+                decoded.document = QJsonDocument::fromJson(data);
+                decoded.documentParsed = true;
+
+                if (decodeObjects && !isError(status))
+                {
+                    decoded.objects = decodeResults(className, decoded.document, false);
+                    decoded.objectsDecoded = true;
+                }
+            }
+
+            pPromise->start();
+            pPromise->addResult(decoded);
+            pPromise->finish();
+        });
+    }
+
+    // decodes the results completed so far without waiting for the rest of the response
+    void ParseReply::streamData(const QByteArray& data)
+    {
+        if (!_pTokenizer)
+            return;
+
+        QList<ParseObject> objects;
+        for (auto const& jsonObject : _pTokenizer->append(data))
+        {
+            if (!jsonObject.value(Parse::ObjectIdKey).toString().isEmpty())
+                objects.append(ParseConvert::toObject(_className, jsonObject));
+        }
+
+        if (!objects.isEmpty())
+            emit resultsAvailable(objects);
+    }
+
+    // completes the reply with the result of its network request, a coalesced /batch response or the query cache
+    void ParseReply::finish(int status, const QByteArray &data, const DecodedReply* pDecoded)
     {
-        if (!_pReply)
+        // an aborted reply has already finished
+        if (_aborted)
             return;
 
+        if (_pDeadlineTimer)
+            _pDeadlineTimer->stop();
+
+        _pNetworkRequest = nullptr;
         _errorCode = 0;
 
-        _statusCode = statusCode(_pReply);
-        _data = _pReply->readAll();
+        _statusCode = status;
+        _data = _pTokenizer ? _pTokenizer->envelope() : data;
+        _pTokenizer.reset();
+        _document = QJsonDocument();
+        _documentParsed = false;
+        _objects.clear();
+        _objectsDecoded = false;
+
+        if (pDecoded)
+        {
+            _document = pDecoded->document;
+            _documentParsed = pDecoded->documentParsed;
+            _objects = pDecoded->objects;
+            _objectsDecoded = pDecoded->objectsDecoded;
+
+            if (!_dataRetained && _documentParsed && !_document.isNull())
+                _data.clear();
+        }
 
         if (isError(_statusCode))
         {
-            _errorCode = errorCode(_data);
-            _errorMessage = errorMessage(_data);
+            QJsonObject jsonObject = document().object();
+            _errorCode = jsonObject.value("code").toInt();
+            _errorMessage = jsonObject.value("error").toString();
 
             if (_errorCode != ParseError::NoError)
                 qWarning() << QString("Parse Error: %1 %2").arg(_errorCode).arg(_errorMessage);
@@ -156,8 +516,7 @@ namespace cg
 
         if (ParseClient::get()->isLoggingEnabled())
         {
-            QJsonDocument doc = QJsonDocument::fromJson(_data);
-            QByteArray formatedContent = doc.toJson(QJsonDocument::Indented);
+            QByteArray formatedContent = document().toJson(QJsonDocument::Indented);
 
             qDebug() << QString("Network Reply: status = %1, error = %2 %3").arg(_statusCode).arg(_errorCode).arg(_errorMessage);
             qDebug().noquote() << formatedContent;
@@ -166,34 +525,35 @@ namespace cg
 
         emit preFinished();
         emit finished();
-
-        _pReply->deleteLater();
     }
 
-    int ParseReply::count() const
+    // completes the reply with the result of another reply, sharing what that reply already decoded
+    void ParseReply::finish(const ParseReply* pSource)
     {
-        int count = 0;
+        DecodedReply decoded;
+        decoded.document = pSource->_document;
+        decoded.documentParsed = pSource->_documentParsed;
 
-        QJsonDocument doc = QJsonDocument::fromJson(constData());
-        if (doc.isObject())
+        if (pSource->_objectsDecoded && pSource->_className == _className)
         {
-            QJsonObject obj = doc.object();
-            count = obj.value("count").toInt();
+            decoded.objects = pSource->_objects;
+            decoded.objectsDecoded = true;
         }
 
-        return count;
+        finish(pSource->statusCode(), pSource->constData(), &decoded);
+    }
+
+    int ParseReply::count() const
+    {
+        return document().object().value("count").toInt();
     }
 
     ParseUser ParseReply::user() const
     {
         ParseUser user = ParseUser::create();
 
-        QJsonDocument doc = QJsonDocument::fromJson(constData());
-        if (doc.isObject())
-        {
-            user.setValues(ParseConvert::toVariantMap(doc.object()));
-            user.clearDirtyState();
-        }
+        if (document().isObject())
+            user = ParseUser(ParseConvert::toObject(Parse::UserClassNameKey, document().object()));
 
         return user;
     }
@@ -202,13 +562,8 @@ namespace cg
     {
         ParseSession session;
 
-        QJsonDocument doc = QJsonDocument::fromJson(constData());
-        if (doc.isObject())
-        {
-            session = ParseSession::create();
-            session.setValues(ParseConvert::toVariantMap(doc.object()));
-            session.clearDirtyState();
-        }
+        if (document().isObject())
+            session = ParseSession(ParseConvert::toObject(Parse::SessionClassNameKey, document().object()));
 
         return session;
     }
@@ -218,55 +573,14 @@ namespace cg
         return status >= 400 && status < 500;
     }
 
-    QVariantMap ParseReply::graphQLResult() const
-    {
-        QVariantMap resultMap;
-
-        QJsonDocument doc = QJsonDocument::fromJson(constData());
-        if (doc.isObject())
-        {
-            QJsonObject obj = doc.object();
-            resultMap = obj.toVariantMap();
-        }
-
-        return resultMap;
-    }
-
-    int ParseReply::statusCode(QNetworkReply *pReply)
-    {
-        int status = 0;
-
-        if (pReply)
-            status = pReply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
-
-        return status;
-    }
-
-    int ParseReply::errorCode(const QByteArray &data)
+    // the results by column, decoded from the document without creating objects
+    ParseResultTable ParseReply::table(const QStringList& keys) const
     {
-        int error = 0;
-
-        QJsonDocument doc = QJsonDocument::fromJson(data);
-        if (doc.isObject())
-        {
-            QJsonObject jsonObject = doc.object();
-            error = jsonObject.value("code").toInt();
-        }
-
-        return error;
+        return ParseResultTable(document().object().value("results").toArray(), keys);
     }
 
-    QString ParseReply::errorMessage(const QByteArray &data)
+    QVariantMap ParseReply::graphQLResult() const
     {
-        QString message;
-
-        QJsonDocument doc = QJsonDocument::fromJson(data);
-        if (doc.isObject())
-        {
-            QJsonObject jsonObject = doc.object();
-            message = jsonObject.value("error").toString();
-        }
-
-        return message;
+        return document().object().toVariantMap();
     }
 }
@@ -30,11 +30,14 @@ namespace cg
 
     ParseRequest::ParseRequest()
         : _method(UnknownHttpMethod)
+        , _priority(NormalPriority)
+        , _transferTimeout(0)
     {
     }
 
     ParseRequest::ParseRequest(HttpMethod method, const QString & apiRoute)
         : _method(method),
+        _priority(NormalPriority),
         _apiRoute(apiRoute)
     {
         init();
@@ -42,6 +45,7 @@ namespace cg
 
     ParseRequest::ParseRequest(HttpMethod method, const QString & apiRoute, const QByteArray & content, const QString &contentType)
         : _method(method),
+        _priority(NormalPriority),
         _apiRoute(apiRoute),
         _contentType(contentType),
         _content(content)
@@ -52,21 +56,29 @@ namespace cg
     ParseRequest::ParseRequest(const ParseRequest & request)
     {
         _method = request._method;
+        _priority = request._priority;
         _apiRoute = request._apiRoute;
         _contentType = request._contentType;
         _urlQuery = request._urlQuery;
         _content = request._content;
         _headers = request._headers;
+        _retryPolicy = request._retryPolicy;
+        _hedgePolicy = request._hedgePolicy;
+        _transferTimeout = request._transferTimeout;
     }
 
     ParseRequest & ParseRequest::operator=(const ParseRequest &request)
     {
         _method = request._method;
+        _priority = request._priority;
         _apiRoute = request._apiRoute;
         _contentType = request._contentType;
         _urlQuery = request._urlQuery;
         _content = request._content;
         _headers = request._headers;
+        _retryPolicy = request._retryPolicy;
+        _hedgePolicy = request._hedgePolicy;
+        _transferTimeout = request._transferTimeout;
         return *this;
     }
 
@@ -80,6 +92,9 @@ namespace cg
         _headers.insert("User-Agent", userAgent());
         _headers.insert("X-Parse-Application-Id", ParseClient::get()->applicationId());
         _headers.insert("X-Parse-REST-API-Key", ParseClient::get()->clientKey());
+        _retryPolicy = ParseClient::get()->retryPolicy();
+        _hedgePolicy = ParseClient::get()->hedgePolicy();
+        _transferTimeout = ParseClient::get()->transferTimeout();
 
         ParseUser user = ParseUser::currentUser();
         if (!user.sessionToken().isEmpty())
@@ -141,6 +156,49 @@ namespace cg
         _content = content;
     }
 
+    ParseRequest::Priority ParseRequest::priority() const
+    {
+        return _priority;
+    }
+
+    void ParseRequest::setPriority(Priority priority)
+    {
+        _priority = priority;
+    }
+
+    ParseRetryPolicy ParseRequest::retryPolicy() const
+    {
+        return _retryPolicy;
+    }
+
+    // requests start with the policy of ParseClient, a maxAttempts of 1 never retries
+    void ParseRequest::setRetryPolicy(const ParseRetryPolicy &policy)
+    {
+        _retryPolicy = policy;
+    }
+
+    int ParseRequest::transferTimeout() const
+    {
+        return _transferTimeout;
+    }
+
+    // an attempt that transfers no data for this long is aborted, and retried if the retry policy allows, 0 for no timeout
+    void ParseRequest::setTransferTimeout(int msecs)
+    {
+        _transferTimeout = msecs;
+    }
+
+    ParseHedgePolicy ParseRequest::hedgePolicy() const
+    {
+        return _hedgePolicy;
+    }
+
+    // requests start with the policy of ParseClient, only GET requests that are not bulk or streamed are hedged
+    void ParseRequest::setHedgePolicy(const ParseHedgePolicy &policy)
+    {
+        _hedgePolicy = policy;
+    }
+
     QByteArray ParseRequest::header(const QByteArray & header) const
     {
         return _headers.value(header);
@@ -183,6 +241,21 @@ namespace cg
             url.setQuery(_urlQuery);
         QNetworkRequest request(url);
 
+        switch (_priority)
+        {
+        case InteractivePriority:
+            request.setPriority(QNetworkRequest::HighPriority);
+            break;
+        case BulkPriority:
+            request.setPriority(QNetworkRequest::LowPriority);
+            break;
+        default:
+            break;
+        }
+
+        if (_transferTimeout > 0)
+            request.setTransferTimeout(_transferTimeout);
+
         if (!_contentType.isEmpty())
             request.setHeader(QNetworkRequest::ContentTypeHeader, _contentType.toUtf8());
 
@@ -0,0 +1,148 @@
+/**
+* Copyright 2017 Charles Glancy (charles@glancyfamily.net)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+* files (the "Software"), to deal in the Software without restriction, including  without limitation the rights to use, copy,
+* modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+* is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+* WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "parseresultstokenizer.h"
+#include "parsejsonreader.h"
+
+#include <QJsonDocument>
+
+namespace cg
+{
+    ParseResultsTokenizer::ParseResultsTokenizer()
+        : _state(BeforeResults)
+        , _depth(0)
+        , _stringStart(-1)
+        , _elementStart(-1)
+        , _envelopeStart(0)
+        , _inString(false)
+        , _escaped(false)
+    {
+    }
+
+    QList<QJsonObject> ParseResultsTokenizer::append(const QByteArray& data)
+    {
+        QList<QJsonObject> objects;
+
+        int pos = _buffer.size();
+        _buffer.append(data);
+
+        const char* p = _buffer.constData();
+        const int size = _buffer.size();
+
+        for (; pos < size; pos++)
+        {
+            char c = p[pos];
+
+            if (_inString)
+            {
+                if (_escaped)
+                {
+                    _escaped = false;
+                    continue;
+                }
+
+                // skip the body of the string in bulk
+                pos = int(ParseJsonReader::findStringEnd(p + pos, p + size) - p);
+                if (pos == size)
+                    break;
+
+                if (p[pos] == '\\')
+                {
+                    _escaped = true;
+                }
+                else
+                {
+                    // a string at the top level followed by an array may be the results key
+                    _inString = false;
+                    if (_depth == 1)
+                        _lastKey = QByteArray(p + _stringStart + 1, pos - _stringStart - 1);
+                }
+
+                continue;
+            }
+
+            switch (c)
+            {
+            case '"':
+                _inString = true;
+                _stringStart = pos;
+                break;
+
+            case '{':
+            case '[':
+                if (_state == InResults && _depth == 2 && _elementStart < 0)
+                    _elementStart = pos;
+
+                _depth++;
+
+                if (c == '[' && _depth == 2 && _state == BeforeResults && _lastKey == "results")
+                {
+                    _envelope.append(p + _envelopeStart, pos + 1 - _envelopeStart);
+                    _envelopeStart = -1;
+                    _state = InResults;
+                }
+                break;
+
+            case '}':
+            case ']':
+                _depth--;
+
+                if (_state != InResults)
+                    break;
+
+                if (_depth == 2 && _elementStart >= 0)
+                {
+                    QJsonDocument doc = QJsonDocument::fromJson(QByteArray::fromRawData(p + _elementStart, pos + 1 - _elementStart));
+                    if (doc.isObject())
+                        objects.append(doc.object());
+
+                    _elementStart = -1;
+                }
+                else if (_depth == 1)
+                {
+                    _state = AfterResults;
+                    _envelopeStart = pos;
+                }
+                break;
+
+            default:
+                break;
+            }
+        }
+
+        if (_envelopeStart >= 0)
+        {
+            _envelope.append(p + _envelopeStart, size - _envelopeStart);
+            _envelopeStart = size;
+        }
+
+        // drop everything but the unfinished element or key
+        int keepFrom = _elementStart >= 0 ? _elementStart : (_inString ? _stringStart : size);
+        _buffer.remove(0, keepFrom);
+
+        if (_elementStart >= 0)
+            _elementStart -= keepFrom;
+        if (_envelopeStart >= 0)
+            _envelopeStart -= keepFrom;
+        _stringStart -= keepFrom;
+
+        return objects;
+    }
+
+    QByteArray ParseResultsTokenizer::envelope() const
+    {
+        return _envelope;
+    }
+}
@@ -0,0 +1,55 @@
+/**
+* Copyright 2017 Charles Glancy (charles@glancyfamily.net)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+* files (the "Software"), to deal in the Software without restriction, including  without limitation the rights to use, copy,
+* modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+* is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+* WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#ifndef CGPARSE_PARSERESULTSTOKENIZER_H
+#define CGPARSE_PARSERESULTSTOKENIZER_H
+#pragma once
+
+#include "parse.h"
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QList>
+
+namespace cg
+{
+    // Picks the elements of the "results" array out of a query response while it is
+    // still arriving. Each element is returned as soon as its closing brace is seen and
+    // its bytes are dropped, so only the unfinished element is held in memory. Everything
+    // outside the results array is kept as the envelope, e.g. {"results":[],"count":20}.
+    class ParseResultsTokenizer
+    {
+    public:
+        ParseResultsTokenizer();
+
+        QList<QJsonObject> append(const QByteArray& data);
+        QByteArray envelope() const;
+
+    private:
+        enum State
+        {
+            BeforeResults,
+            InResults,
+            AfterResults
+        };
+
+        QByteArray _buffer, _envelope, _lastKey;
+        State _state;
+        int _depth, _stringStart, _elementStart, _envelopeStart;
+        bool _inString, _escaped;
+    };
+}
+
+#endif // CGPARSE_PARSERESULTSTOKENIZER_H
@@ -0,0 +1,264 @@
+/**
+* Copyright 2017 Charles Glancy (charles@glancyfamily.net)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+* files (the "Software"), to deal in the Software without restriction, including  without limitation the rights to use, copy,
+* modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+* is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+* WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "parseresulttable.h"
+#include "parseconvert.h"
+#include "parseclient.h"
+
+#include <QJsonObject>
+#include <QDateTime>
+#include <QSet>
+
+#include <cmath>
+
+namespace cg
+{
+    // doubles hold every integer up to 2^53 exactly
+    static const double MaxExactInteger = 9007199254740992.0;
+
+    ParseResultTable::ParseResultTable()
+        : _rowCount(0)
+    {
+    }
+
+    // without keys every key found in the results gets a column
+    ParseResultTable::ParseResultTable(const QJsonArray &results, const QStringList &keys)
+        : _rowCount(results.size())
+        , _keys(keys)
+    {
+        if (_keys.isEmpty())
+        {
+            QSet<QString> keySet;
+            for (const QJsonValue &result : results)
+            {
+                const QJsonObject object = result.toObject();
+                for (auto it = object.constBegin(); it != object.constEnd(); ++it)
+                    keySet.insert(it.key());
+            }
+
+            _keys = QStringList(keySet.begin(), keySet.end());
+            _keys.sort();
+        }
+
+        for (const QString &key : std::as_const(_keys))
+            _columns.insert(key, decodeColumn(results, key));
+    }
+
+    bool ParseResultTable::isEmpty() const
+    {
+        return _rowCount == 0;
+    }
+
+    int ParseResultTable::rowCount() const
+    {
+        return _rowCount;
+    }
+
+    QStringList ParseResultTable::keys() const
+    {
+        return _keys;
+    }
+
+    bool ParseResultTable::contains(const QString &key) const
+    {
+        return _columns.contains(key);
+    }
+
+    ParseResultTable::ColumnType ParseResultTable::columnType(const QString &key) const
+    {
+        return _columns.value(key).type;
+    }
+
+    bool ParseResultTable::isNull(const QString &key, int row) const
+    {
+        auto it = _columns.constFind(key);
+        if (it == _columns.constEnd() || row < 0 || row >= _rowCount)
+            return true;
+
+        return it->nulls.testBit(row);
+    }
+
+    // a set bit marks a row without a value
+    QBitArray ParseResultTable::nulls(const QString &key) const
+    {
+        auto it = _columns.constFind(key);
+        return it != _columns.constEnd() ? it->nulls : QBitArray(_rowCount, true);
+    }
+
+    QList<double> ParseResultTable::doubles(const QString &key) const
+    {
+        return _columns.value(key).doubles;
+    }
+
+    QList<qint64> ParseResultTable::integers(const QString &key) const
+    {
+        return _columns.value(key).integers;
+    }
+
+    QStringList ParseResultTable::strings(const QString &key) const
+    {
+        return _columns.value(key).strings;
+    }
+
+    QVariantList ParseResultTable::variants(const QString &key) const
+    {
+        return _columns.value(key).variants;
+    }
+
+    ParseResultTable::ColumnType ParseResultTable::valueType(const QString &key, const QJsonValue &value)
+    {
+        switch (value.type())
+        {
+        case QJsonValue::Bool:
+            return BoolColumn;
+
+        case QJsonValue::Double:
+        {
+            double number = value.toDouble();
+            return std::floor(number) == number && std::fabs(number) <= MaxExactInteger ? IntegerColumn : DoubleColumn;
+        }
+
+        case QJsonValue::String:
+            return key == Parse::CreatedAtKey || key == Parse::UpdatedAtKey ? DateColumn : StringColumn;
+
+        case QJsonValue::Object:
+        {
+            QString type = value.toObject().value(Parse::TypeKey).toString();
+            if (type == Parse::DateValue)
+                return DateColumn;
+            else if (type == Parse::PointerValue)
+                return PointerColumn;
+            else if (type == Parse::GeoPointValue)
+                return GeoPointColumn;
+
+            return VariantColumn;
+        }
+
+        case QJsonValue::Array:
+            return VariantColumn;
+
+        default:
+            return NullColumn;
+        }
+    }
+
+    // integers widen to doubles, any other mix of types keeps the values as variants
+    ParseResultTable::ColumnType ParseResultTable::mergeTypes(ColumnType type1, ColumnType type2)
+    {
+        if (type1 == NullColumn || type1 == type2)
+            return type2;
+        else if (type2 == NullColumn)
+            return type1;
+        else if ((type1 == IntegerColumn && type2 == DoubleColumn) || (type1 == DoubleColumn && type2 == IntegerColumn))
+            return DoubleColumn;
+
+        return VariantColumn;
+    }
+
+    ParseResultTable::Column ParseResultTable::decodeColumn(const QJsonArray &results, const QString &key)
+    {
+        Column column;
+        int rowCount = results.size();
+        bool identityMapped = ParseClient::get()->isIdentityMapEnabled();
+
+        for (const QJsonValue &result : results)
+            column.type = mergeTypes(column.type, valueType(key, result.toObject().value(key)));
+
+        column.nulls = QBitArray(rowCount);
+
+        switch (column.type)
+        {
+        case DoubleColumn:
+            column.doubles.reserve(rowCount);
+            break;
+        case GeoPointColumn:
+            column.doubles.reserve(rowCount * 2);
+            break;
+        case IntegerColumn:
+        case BoolColumn:
+        case DateColumn:
+            column.integers.reserve(rowCount);
+            break;
+        case StringColumn:
+        case PointerColumn:
+            column.strings.reserve(rowCount);
+            break;
+        case VariantColumn:
+            column.variants.reserve(rowCount);
+            break;
+        case NullColumn:
+            column.nulls.fill(true);
+            return column;
+        }
+
+        for (int row = 0; row < rowCount; ++row)
+        {
+            QJsonValue value = results.at(row).toObject().value(key);
+            bool null = value.isNull() || value.isUndefined();
+
+            switch (column.type)
+            {
+            case DoubleColumn:
+                column.doubles.append(value.toDouble());
+                break;
+
+            case GeoPointColumn:
+            {
+                QJsonObject geoPoint = value.toObject();
+                column.doubles.append(geoPoint.value(Parse::LatitudeKey).toDouble());
+                column.doubles.append(geoPoint.value(Parse::LongitudeKey).toDouble());
+                break;
+            }
+
+            case IntegerColumn:
+                column.integers.append(static_cast<qint64>(value.toDouble()));
+                break;
+
+            case BoolColumn:
+                column.integers.append(value.toBool() ? 1 : 0);
+                break;
+
+            case DateColumn:
+            {
+                QString iso = value.isObject() ? value.toObject().value(Parse::IsoDateKey).toString() : value.toString();
+                QDateTime dateTime = QDateTime::fromString(iso, Qt::ISODateWithMs);
+                null = null || !dateTime.isValid();
+                column.integers.append(dateTime.isValid() ? dateTime.toMSecsSinceEpoch() : 0);
+                break;
+            }
+
+            case StringColumn:
+                column.strings.append(value.toString());
+                break;
+
+            case PointerColumn:
+                column.strings.append(value.toObject().value(Parse::ObjectIdKey).toString());
+                break;
+
+            case VariantColumn:
+                column.variants.append(null ? QVariant() : ParseConvert::decodeValue(value, identityMapped));
+                break;
+
+            case NullColumn:
+                break;
+            }
+
+            if (null)
+                column.nulls.setBit(row);
+        }
+
+        return column;
+    }
+}
@@ -0,0 +1,243 @@
+/**
+* Copyright 2017 Charles Glancy (charles@glancyfamily.net)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+* files (the "Software"), to deal in the Software without restriction, including  without limitation the rights to use, copy,
+* modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+* is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+* WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "parsesaveplan.h"
+#include "parsebatchpipeline.h"
+#include "parseobjectrequest.h"
+#include "parseclient.h"
+#include "parsereply.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+namespace cg
+{
+    ParseSavePlan::ParseSavePlan(const QList<ParseObject>& objects, const QSet<ParseObject>& excludedObjects, QNetworkAccessManager* pNam)
+        : _pNam(pNam)
+        , _visitedObjects(excludedObjects)
+        , _pPipeline(nullptr)
+        , _nextLevel(0)
+    {
+        for (auto & object : objects)
+        {
+            _visitedObjects.insert(object);
+            addChildren(object);
+        }
+    }
+
+    ParseSavePlan::~ParseSavePlan()
+    {
+    }
+
+    bool ParseSavePlan::isEmpty() const
+    {
+        return _levelMap.isEmpty() && _files.isEmpty();
+    }
+
+    QList<ParseObject> ParseSavePlan::children() const
+    {
+        return _heightMap.keys();
+    }
+
+    // Returns the height of the object in the dependency graph. Objects without
+    // unsaved children have height 0 and are saved in the first level.
+    int ParseSavePlan::addChildren(const ParseObject& object)
+    {
+        QList<ParseFile> files;
+        QList<ParseObject> objects;
+        ParseObjectRequest::get()->collectDirtyChildren(object, files, objects);
+
+        int height = 0;
+
+        for (auto & file : files)
+        {
+            if (file.isNull() || !file.isDirty())
+                continue;
+
+            if (!_files.contains(file))
+                _files.append(file);
+
+            height = 1;
+        }
+
+        for (auto & child : objects)
+        {
+            if (child.isNull() || child.className() == Parse::UserClassNameKey)
+                continue;
+
+            // a pointer made with createWithoutData() only has its objectId dirty, there is nothing to save
+            if (!child.objectId().isEmpty() && (!child.isDirty() || child.dirtyKeys() == QStringList(Parse::ObjectIdKey)))
+                continue;
+
+            int childHeight = 0;
+
+            if (_heightMap.contains(child))
+            {
+                childHeight = _heightMap.value(child);
+            }
+            else if (_visitedObjects.contains(child))
+            {
+                // already being saved or a cycle back to an ancestor
+                continue;
+            }
+            else
+            {
+                _visitedObjects.insert(child);
+                childHeight = addChildren(child);
+                _heightMap.insert(child, childHeight);
+                _levelMap[childHeight].append(child);
+            }
+
+            height = qMax(height, childHeight + 1);
+        }
+
+        return height;
+    }
+
+    void ParseSavePlan::start()
+    {
+        saveNextLevel();
+    }
+
+    void ParseSavePlan::saveNextLevel()
+    {
+        int lastLevel = _levelMap.isEmpty() ? 0 : _levelMap.lastKey();
+
+        while (_pendingReplies.isEmpty() && !_pPipeline && _nextLevel <= lastLevel)
+        {
+            if (_nextLevel == 0)
+            {
+                for (auto & file : _files)
+                    addPendingReply(file.save(_pNam));
+            }
+
+            // the pipeline keeps at most ParseClient::maxBatchesInFlight() batches of the level in flight
+            QList<ParseObject> objects = _levelMap.value(_nextLevel);
+            if (!objects.isEmpty())
+            {
+                QNetworkAccessManager *pNam = _pNam;
+                _pPipeline = new ParseBatchPipeline(objects.size(), [objects, pNam](int from, int count)
+                {
+                    return ParseObjectRequest::get()->saveObjects(objects.mid(from, count), pNam);
+                }, this);
+
+                connect(_pPipeline, &ParseBatchPipeline::finished, this, &ParseSavePlan::levelFinished);
+                _pPipeline->start();
+            }
+
+            _nextLevel++;
+        }
+
+        if (_pendingReplies.isEmpty() && !_pPipeline)
+            emit finished();
+    }
+
+    // aborts the saves in flight and starts no more levels, finished() is not emitted
+    void ParseSavePlan::abort()
+    {
+        stop();
+        deleteLater();
+    }
+
+    void ParseSavePlan::stop()
+    {
+        _levelMap.clear();
+
+        QSet<ParseReply*> replies;
+        replies.swap(_pendingReplies);
+
+        for (auto pReply : replies)
+        {
+            disconnect(pReply, nullptr, this, nullptr);
+            pReply->abort();
+            pReply->deleteLater();
+        }
+
+        if (_pPipeline)
+        {
+            disconnect(_pPipeline, nullptr, this, nullptr);
+            _pPipeline->abort();
+            _pPipeline = nullptr;
+        }
+    }
+
+    // A child that was not saved fails the plan, the objects above it would point to nothing.
+    // Each operation of a /batch response succeeds or fails on its own, the first error is reported.
+    bool ParseSavePlan::checkResults(int status, const QByteArray& data)
+    {
+        if (status < 200 || status >= 300)
+        {
+            stop();
+            emit failed(status, data);
+            return false;
+        }
+
+        QJsonDocument doc = QJsonDocument::fromJson(data);
+        if (!doc.isArray())
+            return true;
+
+        const QJsonArray resultsArray = doc.array();
+        for (const auto & result : resultsArray)
+        {
+            QJsonObject resultObject = result.toObject();
+            if (resultObject.contains("error"))
+            {
+                stop();
+                emit failed(400, QJsonDocument(resultObject.value("error").toObject()).toJson(QJsonDocument::Compact));
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    void ParseSavePlan::addPendingReply(ParseReply* pReply)
+    {
+        if (!pReply)
+            return;
+
+        _pendingReplies.insert(pReply);
+        connect(pReply, &ParseReply::finished, this, &ParseSavePlan::childReplyFinished);
+    }
+
+    void ParseSavePlan::childReplyFinished()
+    {
+        ParseReply *pReply = qobject_cast<ParseReply*>(sender());
+        if (!pReply)
+            return;
+
+        _pendingReplies.remove(pReply);
+        pReply->deleteLater();
+
+        if (!checkResults(pReply->statusCode(), pReply->data()))
+            return;
+
+        if (_pendingReplies.isEmpty() && !_pPipeline)
+            saveNextLevel();
+    }
+
+    void ParseSavePlan::levelFinished(int status, const QByteArray& data)
+    {
+        _pPipeline->deleteLater();
+        _pPipeline = nullptr;
+
+        if (!checkResults(status, data))
+            return;
+
+        if (_pendingReplies.isEmpty())
+            saveNextLevel();
+    }
+}
@@ -0,0 +1,79 @@
+/**
+* Copyright 2017 Charles Glancy (charles@glancyfamily.net)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+* files (the "Software"), to deal in the Software without restriction, including  without limitation the rights to use, copy,
+* modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+* is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+* WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#ifndef CGPARSE_PARSESAVEPLAN_H
+#define CGPARSE_PARSESAVEPLAN_H
+#pragma once
+
+#include "parse.h"
+#include "parseobject.h"
+#include "parsefile.h"
+
+#include <QObject>
+#include <QList>
+#include <QMap>
+#include <QSet>
+
+class QNetworkAccessManager;
+
+namespace cg
+{
+    class ParseReply;
+    class ParseBatchPipeline;
+
+    // Saves the dirty children of a set of objects ordered by their dependencies.
+    // Children that do not depend on each other form a level and are sent together
+    // through a ParseBatchPipeline. Each level starts when the one below it has finished,
+    // and the first child that fails to save stops the plan with its error.
+    class ParseSavePlan : public QObject
+    {
+        Q_OBJECT
+    public:
+        ParseSavePlan(const QList<ParseObject>& objects, const QSet<ParseObject>& excludedObjects, QNetworkAccessManager* pNam);
+        ~ParseSavePlan();
+
+        bool isEmpty() const;
+        QList<ParseObject> children() const;
+        void start();
+        void abort();
+
+    signals:
+        void finished();
+        void failed(int status, const QByteArray& data);
+
+    private slots:
+        void childReplyFinished();
+        void levelFinished(int status, const QByteArray& data);
+
+    private:
+        int addChildren(const ParseObject& object);
+        void saveNextLevel();
+        void addPendingReply(ParseReply* pReply);
+        void stop();
+        bool checkResults(int status, const QByteArray& data);
+
+    private:
+        QNetworkAccessManager* _pNam;
+        QSet<ParseObject> _visitedObjects;
+        QMap<ParseObject, int> _heightMap;
+        QMap<int, QList<ParseObject>> _levelMap;
+        QList<ParseFile> _files;
+        QSet<ParseReply*> _pendingReplies;
+        ParseBatchPipeline* _pPipeline;
+        int _nextLevel;
+    };
+}
+
+#endif // CGPARSE_PARSESAVEPLAN_H
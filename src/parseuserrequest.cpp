@@ -128,9 +128,7 @@ namespace cg
 
 	ParseReply* ParseUserRequest::signUp(const ParseUser& user, QNetworkAccessManager* pNam)
 	{
-		QJsonObject object = ParseConvert::toJsonObject(user.toMap());
-		QJsonDocument doc(object);
-		QByteArray content = doc.toJson(QJsonDocument::Compact);
+		QByteArray content = ParseConvert::toJson(user.toMap());
 
 		ParseRequest request(ParseRequest::PostHttpMethod, "/users", content);
 		request.setHeader("X-Parse-Revocable-Session", "1");
@@ -151,11 +149,10 @@ namespace cg
 
 		if (!pReply->isError() && pReply->statusCode() == 201 && !user.isNull())
 		{
-			QJsonDocument doc = QJsonDocument::fromJson(pReply->data());
+			const QJsonDocument &doc = pReply->document();
 			if (doc.isObject())
 			{
-				user.setValues(ParseConvert::toVariantMap(doc.object()));
-				user.clearDirtyState();
+				user.setServerValues(ParseConvert::toVariantMap(doc.object()));
 
 				ParseUser::_currentUser = user;
 			}
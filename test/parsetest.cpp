@@ -511,6 +511,136 @@ void ParseTest::testVariant()
     QCOMPARE(user3.username(), QString("testUser"));
 }
 
+void ParseTest::testConvert()
+{
+    QByteArray json = R"({
+        "objectId": "quote1",
+        "rank": 3,
+        "ratio": 0.5,
+        "quote": "Never tell me the odds!",
+        "deleted": null,
+        "movie": { "__type": "Pointer", "className": "TestMovie", "objectId": "movie1" },
+        "character": { "__type": "Object", "className": "TestCharacter", "objectId": "han", "name": "Han Solo" },
+        "poster": { "__type": "File", "name": "poster.png", "url": "http://localhost/poster.png" },
+        "date": { "__type": "Date", "iso": "2019-02-24T10:30:00.000Z" },
+        "tags": [ "smuggler", { "__type": "Pointer", "className": "TestMovie", "objectId": "movie2" } ]
+    })";
+
+    QJsonObject jsonObject = QJsonDocument::fromJson(json).object();
+    QVariantMap map = ParseConvert::toVariantMap(jsonObject);
+
+    QCOMPARE(map.value("rank"), jsonObject.value("rank").toVariant());
+    QCOMPARE(map.value("ratio").toDouble(), 0.5);
+    QCOMPARE(map.value("quote").toString(), QString("Never tell me the odds!"));
+    QVERIFY(map.contains("deleted"));
+
+    ParseObject movie = map.value("movie").value<ParseObject>();
+    QCOMPARE(movie.className(), QString("TestMovie"));
+    QCOMPARE(movie.objectId(), QString("movie1"));
+    QVERIFY(!movie.isDirty());
+
+    ParseObject character = map.value("character").value<ParseObject>();
+    QCOMPARE(character.className(), QString("TestCharacter"));
+    QCOMPARE(character.value("name").toString(), QString("Han Solo"));
+    QVERIFY(!character.keys().contains(Parse::TypeKey));
+
+    ParseFile poster = map.value("poster").value<ParseFile>();
+    QCOMPARE(poster.name(), QString("poster.png"));
+
+    QCOMPARE(map.value("date").toMap().value(Parse::IsoDateKey).toString(), QString("2019-02-24T10:30:00.000Z"));
+
+    QVariantList tags = map.value("tags").toList();
+    QCOMPARE(tags.size(), 2);
+    QCOMPARE(tags.at(0).toString(), QString("smuggler"));
+    QCOMPARE(tags.at(1).value<ParseObject>().objectId(), QString("movie2"));
+
+    ParseObject quote = ParseConvert::toObject("TestQuote", jsonObject);
+    QCOMPARE(quote.objectId(), QString("quote1"));
+    QVERIFY(!quote.isDirty());
+
+    // decoding straight from the bytes gives the same values
+    QList<ParseObject> results = ParseConvert::toObjects("TestQuote", "{\"results\":[" + json + "]}");
+    QCOMPARE(results.size(), 1);
+    ParseObject result = results.first();
+    QCOMPARE(result.objectId(), QString("quote1"));
+    QVERIFY(!result.isDirty());
+    QCOMPARE(result.value("rank"), quote.value("rank"));
+    QCOMPARE(result.value("ratio"), quote.value("ratio"));
+    QCOMPARE(result.value("quote"), quote.value("quote"));
+    QCOMPARE(result.value("movie").value<ParseObject>().objectId(), QString("movie1"));
+    QCOMPARE(result.value("character").value<ParseObject>().value("name").toString(), QString("Han Solo"));
+    QCOMPARE(result.value("poster").value<ParseFile>().name(), QString("poster.png"));
+    QCOMPARE(result.value("date"), quote.value("date"));
+    QCOMPARE(result.value("tags").toList().at(1).value<ParseObject>().objectId(), QString("movie2"));
+
+    QList<ParseObject> escaped = ParseConvert::toObjects("TestQuote", "{\"results\":[{\"objectId\":\"q\\u00e9\\\"\"}]}");
+    QCOMPARE(escaped.first().objectId(), QString("q%1\"").arg(QChar(0xe9)));
+    QVERIFY(ParseConvert::toObjects("TestQuote", "{\"results\":[{\"objectId\":").isEmpty());
+
+    // repeated short values share one string across the results of a reply
+    QList<ParseObject> pooled = ParseConvert::toObjects("TestQuote", R"({"results":[{"objectId":"a","movie":"A New Hope"},{"objectId":"b","movie":"A New Hope"}]})");
+    QVERIFY(pooled.at(0).value("movie").toString().isSharedWith(pooled.at(1).value("movie").toString()));
+
+    // the direct writer gives the same bytes as QJsonDocument
+    QVariantMap writeMap = map;
+    writeMap.insert("escaped", QString("tab\tquote\"slash\\bell\a %1").arg(QChar(0xe9)));
+    writeMap.insert("large", 1e300);
+    writeMap.insert("negative", -42);
+    writeMap.insert("flag", true);
+    writeMap.insert(Parse::CreatedAtKey, "2019-02-24T10:30:00.000Z");
+    writeMap.insert("nested", QVariantMap { { Parse::UpdatedAtKey, 1 }, { "list", QVariantList { 1, "two", 3.5, QVariant() } } });
+    QCOMPARE(ParseConvert::toJson(writeMap), QJsonDocument(ParseConvert::toJsonObject(writeMap)).toJson(QJsonDocument::Compact));
+}
+
+void ParseTest::testConvertBenchmark_data()
+{
+    QTest::addColumn<bool>("vectorized");
+
+    QTest::newRow("document") << false;
+    QTest::newRow("vectorized") << true;
+}
+
+void ParseTest::testConvertBenchmark()
+{
+    QFETCH(bool, vectorized);
+
+    // a page of query results shaped like the ones the server sends
+    QByteArray data = "{\"results\":[";
+    for (int i = 0; i < 1000; i++)
+    {
+        if (i > 0)
+            data += ",";
+
+        data += QString(R"({"objectId":"quote%1","createdAt":"2019-02-24T10:30:00.000Z","updatedAt":"2019-02-24T10:30:00.000Z",)"
+            R"("quote":"It's a trap! \"Admiral\" Ackbar was right about the Death Star, number %1","rank":%1,"ratio":%2,"deleted":false,)"
+            R"("movie":{"__type":"Pointer","className":"TestMovie","objectId":"movie%1"},)"
+            R"("poster":{"__type":"File","name":"poster%1.png","url":"http://localhost/poster%1.png"},)"
+            R"("tags":["rebel","admiral"],"ACL":{"*":{"read":true}}})").arg(i).arg(i * 0.25).toUtf8();
+    }
+    data += "]}";
+
+    QList<ParseObject> objects = ParseConvert::toObjects("TestQuote", data);
+    QCOMPARE(objects.size(), 1000);
+    QCOMPARE(objects.last().value("rank").toInt(), 999);
+    QCOMPARE(objects.last().value("quote").toString(), QString("It's a trap! \"Admiral\" Ackbar was right about the Death Star, number 999"));
+
+    QBENCHMARK
+    {
+        if (vectorized)
+        {
+            objects = ParseConvert::toObjects("TestQuote", data);
+        }
+        else
+        {
+            objects.clear();
+            for (auto jsonValue : QJsonDocument::fromJson(data).object().value("results").toArray())
+                objects.append(ParseConvert::toObject("TestQuote", jsonValue.toObject()));
+        }
+    }
+
+    QCOMPARE(objects.size(), 1000);
+}
+
 void ParseTest::testDateTime()
 {
     ParseDateTime dt;
@@ -689,6 +819,111 @@ void ParseTest::testObjectRevert()
     QVERIFY(!gameScore.isDirty());
 }
 
+void ParseTest::testObjectDirtyKeys()
+{
+    ParseObject gameScore = ParseObject("TestGameScore");
+    gameScore.setValue("score", 1337);
+    gameScore.setValue("playerName", "Sean Plott");
+    gameScore.clearDirtyState();
+    QVERIFY(!gameScore.isDirty());
+    QVERIFY(gameScore.dirtyKeys().isEmpty());
+
+    gameScore.setValue("score", 1338);
+    gameScore.setValue("cheatMode", false);
+    QCOMPARE(gameScore.dirtyKeys().size(), 2);
+    QVERIFY(gameScore.dirtyKeys().contains("score"));
+    QVERIFY(gameScore.dirtyKeys().contains("cheatMode"));
+    QVERIFY(!gameScore.isDirty("playerName"));
+
+    // setting a value back to its saved value makes it clean
+    gameScore.setValue("score", 1337);
+    QVERIFY(!gameScore.isDirty("score"));
+
+    gameScore.revert("cheatMode");
+    QVERIFY(!gameScore.isDirty());
+    QVERIFY(!gameScore.keys().contains("cheatMode"));
+    QCOMPARE(gameScore.value("score").toInt(), 1337);
+}
+
+void ParseTest::testObjectKeys()
+{
+    // objects built with the same keys in any order look the same
+    ParseObject score1 = ParseObject("TestGameScore");
+    score1.setValue("score", 1337);
+    score1.setValue("playerName", "Sean Plott");
+    score1.setValue("cheatMode", false);
+
+    ParseObject score2 = ParseObject("TestGameScore");
+    score2.setValue("cheatMode", true);
+    score2.setValue("score", 1000);
+
+    QCOMPARE(score1.keys(), QStringList({ "cheatMode", "playerName", "score" }));
+    QCOMPARE(score2.keys(), QStringList({ "cheatMode", "score" }));
+    QVERIFY(!score2.contains("playerName"));
+    QVERIFY(!score2.value("playerName").isValid());
+
+    QVariantMap map = score1.toMap();
+    QCOMPARE(map.keys(), score1.keys());
+    QCOMPARE(map.value("score").toInt(), 1337);
+
+    // a reverted key is gone from the keys and the map
+    score1.clearDirtyState();
+    score1.setValue("level", 7);
+    QVERIFY(score1.contains("level"));
+    score1.revert();
+    QVERIFY(!score1.contains("level"));
+    QCOMPARE(score1.toMap(), map);
+
+    // decoded objects take the keys of the server data
+    QList<ParseObject> results = ParseConvert::toObjects("TestGameScore", R"({"results":[{"objectId":"a","score":1},{"objectId":"b","score":2,"extra":true}]})");
+    QCOMPARE(results.size(), 2);
+    QCOMPARE(results.at(0).keys(), QStringList({ "objectId", "score" }));
+    QCOMPARE(results.at(1).keys(), QStringList({ "extra", "objectId", "score" }));
+    QCOMPARE(results.at(1).value("score").toInt(), 2);
+
+    // decoded objects start clean, a key only keeps its old value once it is changed
+    ParseObject result = results.at(0);
+    QVERIFY(!result.isDirty());
+    result.setValue("score", 5);
+    QCOMPARE(result.dirtyKeys(), QStringList("score"));
+    result.revert();
+    QCOMPARE(result.value("score").toInt(), 1);
+    QVERIFY(!result.isDirty());
+}
+
+void ParseTest::testObjectRecord()
+{
+    auto query = ParseQuery<TestQuote>();
+    query.include("movie");
+    ParseReply *pFindReply = query.find();
+    QSignalSpy findSpy(pFindReply, &ParseReply::finished);
+    QVERIFY(findSpy.wait(SPY_WAIT));
+    pFindReply->deleteLater();
+
+    // records hold the same values as the typed accessors
+    QList<TestQuote> quotes = query.results();
+    QList<TestQuoteRecord> records = ParseRecord<TestQuoteRecord>::fromObjects(pFindReply->objects<ParseObject>());
+    QCOMPARE(records.size(), quotes.size());
+
+    for (int i = 0; i < records.size(); ++i)
+    {
+        QCOMPARE(records.at(i).objectId, quotes.at(i).objectId());
+        QCOMPARE(records.at(i).rank, quotes.at(i).rank());
+        QCOMPARE(records.at(i).quote, quotes.at(i).quote());
+        QCOMPARE(records.at(i).movie.title(), quotes.at(i).movie().title());
+        QCOMPARE(records.at(i).createdAt, quotes.at(i).createdAt());
+    }
+
+    // a record converts back to an object of its class
+    TestQuoteRecord record = records.first();
+    record.rank = 99;
+    ParseObject object = ParseRecord<TestQuoteRecord>::toObject(record);
+    QCOMPARE(object.className(), QString("TestQuote"));
+    QCOMPARE(TestQuote(object).rank(), 99);
+    QCOMPARE(TestQuote(object).movie().objectId(), record.movie.objectId());
+    QCOMPARE(ParseRecord<TestQuoteRecord>::fromObject(object).quote, record.quote);
+}
+
 void ParseTest::testObjectArray()
 {
     ParseObject gameScore = ParseObject("TestGameScore");
@@ -794,6 +1029,69 @@ void ParseTest::testObjectReferenceSave()
     QVERIFY(delete3Spy.wait(SPY_WAIT));
 }
 
+void ParseTest::testObjectGraphSave()
+{
+    // the movie is saved first, then the character that points to it, then the quote
+    TestMovie movie = TestMovie("Rogue One: A Star Wars Story");
+    TestCharacter character = TestCharacter("Jyn Erso");
+    character.setObject("firstMovie", movie);
+    TestQuote quote = TestQuote(movie, character, 34, "We have hope. Rebellions are built on hope!");
+
+    ParseReply *pSaveReply = quote.save();
+    QSignalSpy saveSpy(pSaveReply, &ParseReply::finished);
+    QVERIFY(saveSpy.wait(SPY_WAIT));
+    QVERIFY(!pSaveReply->isError());
+    pSaveReply->deleteLater();
+
+    QVERIFY(!movie.objectId().isEmpty());
+    QVERIFY(!character.objectId().isEmpty());
+    QVERIFY(!quote.objectId().isEmpty());
+    QVERIFY(movie.createdAt() <= character.createdAt());
+    QVERIFY(character.createdAt() <= quote.createdAt());
+
+    auto query = ParseQuery<TestQuote>();
+    query.include("character");
+    ParseReply *pGetReply = query.get(quote.objectId());
+    QSignalSpy getSpy(pGetReply, &ParseReply::finished);
+    QVERIFY(getSpy.wait(SPY_WAIT));
+    pGetReply->deleteLater();
+
+    TestQuote gotQuote = pGetReply->first<TestQuote>();
+    QCOMPARE(gotQuote.movie().objectId(), movie.objectId());
+    QCOMPARE(gotQuote.character().objectId(), character.objectId());
+    QCOMPARE(gotQuote.character().object<TestMovie>("firstMovie").objectId(), movie.objectId());
+
+    // a child that cannot be saved fails the save before the quote is written
+    TestCharacter badCharacter = TestCharacter("Saw Gerrera");
+    badCharacter.setValue("invalid-key", 1);
+    TestQuote badQuote = TestQuote(movie, badCharacter, 35, "Save the Rebellion! Save the dream!");
+
+    ParseReply *pBadReply = badQuote.save();
+    QSignalSpy badSpy(pBadReply, &ParseReply::finished);
+    QVERIFY(badSpy.wait(SPY_WAIT));
+    QVERIFY(pBadReply->isError());
+    QVERIFY(badCharacter.objectId().isEmpty());
+    QVERIFY(badQuote.objectId().isEmpty());
+    pBadReply->deleteLater();
+
+    // a pointer made from an objectId has nothing to save and is left alone
+    TestMovie moviePointer = ParseObject::createWithoutData<TestMovie>(movie.objectId());
+    TestQuote pointerQuote = TestQuote(moviePointer, character, 36, "Save the dream!");
+
+    ParseReply *pPointerReply = pointerQuote.save();
+    QSignalSpy pointerSpy(pPointerReply, &ParseReply::finished);
+    QVERIFY(pointerSpy.wait(SPY_WAIT));
+    QVERIFY(!pPointerReply->isError());
+    QVERIFY(!pointerQuote.objectId().isEmpty());
+    QVERIFY(!moviePointer.updatedAt().isValid());
+    pPointerReply->deleteLater();
+
+    QList<ParseObject> objects = { pointerQuote, quote, character, movie };
+    ParseReply *pDeleteReply = ParseObject::deleteAll(objects);
+    QSignalSpy deleteSpy(pDeleteReply, &ParseReply::finished);
+    QVERIFY(deleteSpy.wait(SPY_WAIT));
+    pDeleteReply->deleteLater();
+}
 
 void ParseTest::testObjectSetObject()
 {
@@ -802,6 +1100,128 @@ void ParseTest::testObjectSetObject()
     QVERIFY(vader == villian);
 }
 
+void ParseTest::testObjectCoalescing()
+{
+    ParseClient::get()->setCoalescingEnabled(true);
+
+    QList<ParseObject> scores;
+    QList<ParseReply*> saveReplies;
+    for (int i = 0; i < 3; i++)
+    {
+        ParseObject gameScore = ParseObject("TestGameScore");
+        gameScore.setValue("score", 100 + i);
+        scores.append(gameScore);
+        saveReplies.append(gameScore.save());
+    }
+
+    QSignalSpy saveSpy(saveReplies.first(), &ParseReply::finished);
+    QVERIFY(saveSpy.wait(SPY_WAIT));
+
+    // all of the replies are filled from the same /batch response
+    for (int i = 0; i < scores.size(); i++)
+    {
+        QVERIFY(!saveReplies.at(i)->isError());
+        QVERIFY(!scores.at(i).objectId().isEmpty());
+        QVERIFY(!scores.at(i).isDirty());
+    }
+
+    qDeleteAll(saveReplies);
+
+    QList<QSignalSpy*> deleteSpies;
+    for (auto & gameScore : scores)
+        deleteSpies.append(new QSignalSpy(gameScore.deleteObject(), &ParseReply::finished));
+
+    QVERIFY(deleteSpies.last()->wait(SPY_WAIT));
+    for (auto pDeleteSpy : deleteSpies)
+        QCOMPARE(pDeleteSpy->count(), 1);
+    qDeleteAll(deleteSpies);
+
+    ParseClient::get()->setCoalescingEnabled(false);
+}
+
+void ParseTest::testObjectSaveAllChunks()
+{
+    ParseClient::get()->setBatchSize(2);
+    ParseClient::get()->setMaxBatchesInFlight(2);
+
+    QList<ParseObject> scores;
+    for (int i = 0; i < 5; i++)
+    {
+        ParseObject gameScore = ParseObject("TestGameScore");
+        gameScore.setValue("score", 200 + i);
+        scores.append(gameScore);
+    }
+
+    ParseReply *pSaveReply = ParseObject::saveAll(scores);
+    QSignalSpy saveProgressSpy(pSaveReply, &ParseReply::progress);
+    QSignalSpy saveSpy(pSaveReply, &ParseReply::finished);
+    QVERIFY(saveSpy.wait(SPY_WAIT));
+    QVERIFY(!pSaveReply->isError());
+    QCOMPARE(saveProgressSpy.count(), 3);
+    QCOMPARE(saveProgressSpy.last().at(0).toInt(), 5);
+    QCOMPARE(QJsonDocument::fromJson(pSaveReply->data()).array().size(), 5);
+    pSaveReply->deleteLater();
+
+    for (auto & gameScore : scores)
+        QVERIFY(!gameScore.objectId().isEmpty());
+
+    ParseReply *pDeleteReply = ParseObject::deleteAll(scores);
+    QSignalSpy deleteProgressSpy(pDeleteReply, &ParseReply::progress);
+    QSignalSpy deleteSpy(pDeleteReply, &ParseReply::finished);
+    QVERIFY(deleteSpy.wait(SPY_WAIT));
+    QVERIFY(!pDeleteReply->isError());
+    QCOMPARE(deleteProgressSpy.count(), 3);
+    pDeleteReply->deleteLater();
+
+    ParseClient::get()->setBatchSize(50);
+    ParseClient::get()->setMaxBatchesInFlight(4);
+}
+
+void ParseTest::testObjectSaveAllAbort()
+{
+    ParseClient::get()->setBatchSize(2);
+
+    QList<ParseObject> scores;
+    for (int i = 0; i < 5; i++)
+    {
+        ParseObject gameScore = ParseObject("TestGameScore");
+        gameScore.setValue("score", 300 + i);
+        scores.append(gameScore);
+    }
+
+    // aborting the reply cancels the batches before they are sent
+    ParseReply *pSaveReply = ParseObject::saveAll(scores);
+    QSignalSpy abortSpy(pSaveReply, &ParseReply::finished);
+    pSaveReply->abort();
+    QCOMPARE(abortSpy.count(), 1);
+    QVERIFY(pSaveReply->isAborted());
+    QCOMPARE(pSaveReply->errorCode(), int(ParseError::RequestAborted));
+    pSaveReply->deleteLater();
+
+    QTest::qWait(500);
+    QCOMPARE(abortSpy.count(), 1);
+
+    for (auto & gameScore : scores)
+        QVERIFY(gameScore.objectId().isEmpty());
+
+    // the objects can be saved again
+    pSaveReply = ParseObject::saveAll(scores);
+    QSignalSpy saveSpy(pSaveReply, &ParseReply::finished);
+    QVERIFY(saveSpy.wait(SPY_WAIT));
+    QVERIFY(!pSaveReply->isError());
+    pSaveReply->deleteLater();
+
+    for (auto & gameScore : scores)
+        QVERIFY(!gameScore.objectId().isEmpty());
+
+    ParseReply *pDeleteReply = ParseObject::deleteAll(scores);
+    QSignalSpy deleteSpy(pDeleteReply, &ParseReply::finished);
+    QVERIFY(deleteSpy.wait(SPY_WAIT));
+    pDeleteReply->deleteLater();
+
+    ParseClient::get()->setBatchSize(50);
+}
+
 void ParseTest::testQueryNamespace()
 {
     auto query = ParseQuery<ns1::ns2::TestNamespace>();
@@ -857,6 +1277,477 @@ void ParseTest::testQueryCount()
     QCOMPARE(pCountReply->count(), 32);
 }
 
+void ParseTest::testQueryStream()
+{
+    QSet<QString> objectIds;
+    int pages = 0;
+
+    auto query = ParseQuery<TestQuote>();
+    ParseReply *pStreamReply = query.each([&](const QList<TestQuote>& quotes)
+    {
+        pages++;
+        for (auto & quote : quotes)
+            objectIds.insert(quote.objectId());
+    }, 10);
+
+    QSignalSpy streamSpy(pStreamReply, &ParseReply::finished);
+    QVERIFY(streamSpy.wait(SPY_WAIT));
+    QVERIFY(!pStreamReply->isError());
+    pStreamReply->deleteLater();
+
+    QCOMPARE(pages, 4);
+    QCOMPARE(objectIds.size(), 32);
+    QCOMPARE(pStreamReply->count(), 32);
+
+    // a constraint on the cursor key still applies
+    QString id = *objectIds.constBegin();
+    QList<TestQuote> matches;
+
+    auto idQuery = ParseQuery<TestQuote>();
+    idQuery.whereEqualTo("objectId", id);
+    ParseReply *pIdReply = idQuery.each([&](const QList<TestQuote>& quotes)
+    {
+        matches.append(quotes);
+    }, 10);
+
+    QSignalSpy idSpy(pIdReply, &ParseReply::finished);
+    QVERIFY(idSpy.wait(SPY_WAIT));
+    QVERIFY(!pIdReply->isError());
+    pIdReply->deleteLater();
+
+    QCOMPARE(matches.size(), 1);
+    QCOMPARE(matches.first().objectId(), id);
+
+    // a date cursor is compared as a date
+    int dated = 0;
+    ParseReply *pDateReply = ParseQuery<TestQuote>().each([&](const QList<TestQuote>& quotes)
+    {
+        dated += quotes.size();
+    }, 10, Parse::CreatedAtKey);
+
+    QSignalSpy dateSpy(pDateReply, &ParseReply::finished);
+    QVERIFY(dateSpy.wait(SPY_WAIT));
+    QVERIFY(!pDateReply->isError());
+    QVERIFY(dated > 10);
+    QVERIFY(dated <= 32);
+    pDateReply->deleteLater();
+
+    // a page that fails fails the stream, rather than finishing it early as if it were complete
+    auto invalidQuery = ParseQuery<TestQuote>();
+    invalidQuery.whereEqualTo("invalid-key", 1);
+    ParseReply *pInvalidReply = invalidQuery.stream(10);
+    QSignalSpy invalidSpy(pInvalidReply, &ParseReply::finished);
+    QVERIFY(invalidSpy.wait(SPY_WAIT));
+    QVERIFY(pInvalidReply->isError());
+    pInvalidReply->deleteLater();
+
+    ParseClient *pClient = ParseClient::get();
+    QByteArray serverUrl = pClient->serverUrl();
+    pClient->initialize(pClient->applicationId(), pClient->clientKey(), pClient->masterKey(), "http://127.0.0.1:1/parse");
+
+    ParseReply *pFailedReply = ParseQuery<TestQuote>().stream(10);
+    QSignalSpy failedSpy(pFailedReply, &ParseReply::finished);
+    QVERIFY(failedSpy.wait(SPY_WAIT));
+    QCOMPARE(pFailedReply->statusCode(), 0);
+    QCOMPARE(pFailedReply->errorCode(), int(ParseError::ConnectionFailed));
+    pFailedReply->deleteLater();
+
+    pClient->initialize(pClient->applicationId(), pClient->clientKey(), pClient->masterKey(), serverUrl);
+}
+
+void ParseTest::testQueryScan()
+{
+    QStringList objectIds;
+
+    auto query = ParseQuery<TestQuote>();
+    ParseReply *pScanReply = query.scan(4, 2, true);
+    connect(pScanReply, &ParseReply::resultsAvailable, this, [&](const QList<ParseObject>& quotes)
+    {
+        for (auto & quote : quotes)
+            objectIds.append(quote.objectId());
+    });
+
+    QSignalSpy scanSpy(pScanReply, &ParseReply::finished);
+    QVERIFY(scanSpy.wait(SPY_WAIT));
+    QVERIFY(!pScanReply->isError());
+    pScanReply->deleteLater();
+
+    QCOMPARE(objectIds.size(), 32);
+    QStringList sortedIds = objectIds;
+    sortedIds.sort();
+    QCOMPARE(objectIds, sortedIds);
+
+    // a failed partition fails the scan, which finishes once
+    ParseClient *pClient = ParseClient::get();
+    QByteArray serverUrl = pClient->serverUrl();
+    pClient->initialize(pClient->applicationId(), pClient->clientKey(), pClient->masterKey(), "http://127.0.0.1:1/parse");
+
+    ParseReply *pFailedReply = ParseQuery<TestQuote>().scan(4, 4);
+    QSignalSpy failedSpy(pFailedReply, &ParseReply::finished);
+    QVERIFY(failedSpy.wait(SPY_WAIT));
+    QVERIFY(pFailedReply->isError());
+    QCOMPARE(pFailedReply->errorCode(), int(ParseError::ConnectionFailed));
+
+    QTest::qWait(500);
+    QCOMPARE(failedSpy.count(), 1);
+    pFailedReply->deleteLater();
+
+    pClient->initialize(pClient->applicationId(), pClient->clientKey(), pClient->masterKey(), serverUrl);
+}
+
+void ParseTest::testQueryCache()
+{
+    ParseQueryRequest::get()->clearCache();
+
+    auto query = ParseQuery<TestQuote>();
+    query.setCachePolicy(CacheOnly);
+    ParseReply *pMissReply = query.find();
+    QSignalSpy missSpy(pMissReply, &ParseReply::finished);
+    QVERIFY(missSpy.wait(SPY_WAIT));
+    QCOMPARE(pMissReply->errorCode(), int(ParseError::CacheMiss));
+    pMissReply->deleteLater();
+
+    query.setCachePolicy(CacheElseNetwork);
+    ParseReply *pNetworkReply = query.find();
+    QSignalSpy networkSpy(pNetworkReply, &ParseReply::finished);
+    QVERIFY(networkSpy.wait(SPY_WAIT));
+    QCOMPARE(query.results().size(), 32);
+    pNetworkReply->deleteLater();
+
+    query.setCachePolicy(CacheOnly);
+    ParseReply *pCacheReply = query.find();
+    QSignalSpy cacheSpy(pCacheReply, &ParseReply::finished);
+    QVERIFY(cacheSpy.wait(SPY_WAIT));
+    QVERIFY(!pCacheReply->isError());
+    QCOMPARE(query.results().size(), 32);
+    pCacheReply->deleteLater();
+
+    query.setCachePolicy(CacheThenNetwork);
+    ParseReply *pBothReply = query.find();
+    QSignalSpy resultsSpy(pBothReply, &ParseReply::resultsAvailable);
+    QSignalSpy bothSpy(pBothReply, &ParseReply::finished);
+    QVERIFY(bothSpy.wait(SPY_WAIT));
+    QCOMPARE(resultsSpy.count(), 2);
+    pBothReply->deleteLater();
+
+    // get and count deliver the network result after the cached one too
+    TestQuote quote = query.results().first();
+    for (int i = 0; i < 2; i++)
+    {
+        ParseReply *pGetReply = query.get(quote.objectId());
+        QSignalSpy getResultsSpy(pGetReply, &ParseReply::resultsAvailable);
+        QSignalSpy getSpy(pGetReply, &ParseReply::finished);
+        QVERIFY(getSpy.wait(SPY_WAIT));
+        QCOMPARE(getResultsSpy.count(), i + 1);
+        pGetReply->deleteLater();
+
+        ParseReply *pCountReply = query.count();
+        QSignalSpy countResultsSpy(pCountReply, &ParseReply::resultsAvailable);
+        QSignalSpy countSpy(pCountReply, &ParseReply::finished);
+        QVERIFY(countSpy.wait(SPY_WAIT));
+        QCOMPARE(countResultsSpy.count(), i + 1);
+        QCOMPARE(pCountReply->count(), 32);
+        pCountReply->deleteLater();
+    }
+
+    // saving an object of the class drops its cached results
+    int rank = quote.rank();
+    for (int newRank : { rank + 1000, rank })
+    {
+        quote.setRank(newRank);
+        ParseReply *pSaveReply = quote.save();
+        QSignalSpy saveSpy(pSaveReply, &ParseReply::finished);
+        QVERIFY(saveSpy.wait(SPY_WAIT));
+        QVERIFY(!pSaveReply->isError());
+        pSaveReply->deleteLater();
+
+        query.setCachePolicy(CacheOnly);
+        ParseReply *pStaleReply = query.find();
+        QSignalSpy staleSpy(pStaleReply, &ParseReply::finished);
+        QVERIFY(staleSpy.wait(SPY_WAIT));
+        QCOMPARE(pStaleReply->errorCode(), int(ParseError::CacheMiss));
+        pStaleReply->deleteLater();
+
+        query.setCachePolicy(CacheElseNetwork);
+        ParseReply *pRefillReply = query.find();
+        QSignalSpy refillSpy(pRefillReply, &ParseReply::finished);
+        QVERIFY(refillSpy.wait(SPY_WAIT));
+        pRefillReply->deleteLater();
+    }
+}
+
+void ParseTest::testQueryIdentityMap()
+{
+    ParseClient::get()->setIdentityMapEnabled(true);
+
+    auto query = ParseQuery<TestQuote>();
+    query.whereEqualTo("movie", episode4);
+    query.include("movie");
+    ParseReply *pFindReply = query.find();
+    QSignalSpy findSpy(pFindReply, &ParseReply::finished);
+    QVERIFY(findSpy.wait(SPY_WAIT));
+    pFindReply->deleteLater();
+
+    QList<TestQuote> quotes = query.results();
+    QVERIFY(quotes.size() > 1);
+
+    // every quote refers to the same movie instance
+    TestMovie movie1 = quotes.at(0).movie();
+    TestMovie movie2 = quotes.at(1).movie();
+    QVERIFY(!movie1.isDirty());
+    movie1.setValue("identityCheck", true);
+    QVERIFY(movie2.value("identityCheck").toBool());
+    movie1.revert();
+
+    ParseClient::get()->setIdentityMapEnabled(false);
+}
+
+void ParseTest::testQuerySharedRequest()
+{
+    // identical queries in flight at the same time share one network request
+    auto query1 = ParseQuery<TestCharacter>();
+    auto query2 = ParseQuery<TestCharacter>();
+    ParseReply *pFind1Reply = query1.find();
+    ParseReply *pFind2Reply = query2.find();
+    QSignalSpy find1Spy(pFind1Reply, &ParseReply::finished);
+    QSignalSpy find2Spy(pFind2Reply, &ParseReply::finished);
+    QVERIFY(find1Spy.wait(SPY_WAIT));
+    QVERIFY(find2Spy.count() == 1 || find2Spy.wait(SPY_WAIT));
+
+    QCOMPARE(pFind1Reply->data(), pFind2Reply->data());
+    QCOMPARE(query1.results().size(), 20);
+    QCOMPARE(query2.results().size(), 20);
+
+    pFind1Reply->deleteLater();
+    pFind2Reply->deleteLater();
+}
+
+void ParseTest::testQueryPriority()
+{
+    // with one request to the server at a time, an interactive query overtakes waiting bulk queries
+    ParseClient::get()->setMaxRequestsPerHost(1);
+
+    QStringList finishOrder;
+    QList<ParseReply*> replies;
+
+    for (int i = 0; i < 3; i++)
+    {
+        auto query = ParseQuery<TestCharacter>();
+        query.setSkip(i).setPriority(ParseRequest::BulkPriority);
+        ParseReply *pReply = query.find();
+        connect(pReply, &ParseReply::finished, this, [&finishOrder, i]() { finishOrder.append(QString("bulk%1").arg(i)); });
+        replies.append(pReply);
+    }
+
+    auto query = ParseQuery<TestCharacter>();
+    query.setPriority(ParseRequest::InteractivePriority);
+    ParseReply *pFindReply = query.find();
+    connect(pFindReply, &ParseReply::finished, this, [&finishOrder]() { finishOrder.append("interactive"); });
+    replies.append(pFindReply);
+
+    QSignalSpy lastSpy(replies.at(2), &ParseReply::finished);
+    QVERIFY(lastSpy.wait(SPY_WAIT * 4));
+
+    QCOMPARE(finishOrder.size(), 4);
+    QCOMPARE(finishOrder.first(), QString("bulk0"));
+    QVERIFY(finishOrder.indexOf("interactive") < finishOrder.indexOf("bulk1"));
+    QCOMPARE(query.results().size(), 20);
+
+    ParseClient::get()->setMaxRequestsPerHost(6);
+
+    for (auto pReply : replies)
+        pReply->deleteLater();
+
+    // a lane limit holds back requests of its lane only, even while the server has free slots
+    ParseClient::get()->setMaxNormalRequestsPerHost(1);
+
+    QList<ParseReply*> laneReplies;
+    for (int i = 0; i < 3; i++)
+    {
+        auto normalQuery = ParseQuery<TestCharacter>();
+        normalQuery.setSkip(i);
+        laneReplies.append(normalQuery.find());
+    }
+
+    auto interactiveQuery = ParseQuery<TestCharacter>();
+    interactiveQuery.setPriority(ParseRequest::InteractivePriority);
+    laneReplies.append(interactiveQuery.find());
+
+    QCOMPARE(ParseClient::get()->queuedRequestCount(), 2);
+
+    QSignalSpy laneSpy(laneReplies.at(2), &ParseReply::finished);
+    QVERIFY(laneSpy.wait(SPY_WAIT * 3));
+    QCOMPARE(ParseClient::get()->queuedRequestCount(), 0);
+
+    ParseClient::get()->setMaxNormalRequestsPerHost(0);
+
+    for (auto pReply : laneReplies)
+        pReply->deleteLater();
+}
+
+void ParseTest::testQueryAdaptiveConcurrency()
+{
+    // the adaptive limit starts at the configured one, requests beyond it wait
+    ParseClient::get()->setMaxRequestsPerHost(1);
+    ParseClient::get()->setAdaptiveConcurrencyEnabled(true);
+
+    QList<ParseReply*> replies;
+    for (int i = 0; i < 3; i++)
+    {
+        auto query = ParseQuery<TestCharacter>();
+        query.setSkip(i);
+        replies.append(query.find());
+    }
+
+    QCOMPARE(ParseClient::get()->requestLimit(), 1);
+    QCOMPARE(ParseClient::get()->queuedRequestCount(), 2);
+
+    QSignalSpy lastSpy(replies.last(), &ParseReply::finished);
+    QVERIFY(lastSpy.wait(SPY_WAIT * 3));
+
+    // the limit moves with the replies but stays within its bounds
+    QCOMPARE(ParseClient::get()->queuedRequestCount(), 0);
+    QVERIFY(ParseClient::get()->requestLimit() >= 1);
+    QVERIFY(ParseClient::get()->requestLimit() <= 100);
+
+    ParseClient::get()->setAdaptiveConcurrencyEnabled(false);
+    ParseClient::get()->setMaxRequestsPerHost(6);
+    QCOMPARE(ParseClient::get()->requestLimit(), 6);
+
+    for (auto pReply : replies)
+        pReply->deleteLater();
+}
+
+void ParseTest::testQueryReplyDocument()
+{
+    auto query = ParseQuery<TestQuote>();
+    ParseReply *pFindReply = query.find();
+    pFindReply->setDataRetained(false);
+    QSignalSpy findSpy(pFindReply, &ParseReply::finished);
+    QVERIFY(findSpy.wait(SPY_WAIT));
+    pFindReply->deleteLater();
+
+    // the document is parsed once and shared by every accessor
+    const QJsonDocument &document = pFindReply->document();
+    QVERIFY(document.isObject());
+    QCOMPARE(&pFindReply->document(), &document);
+
+    QList<TestQuote> quotes = pFindReply->objects<TestQuote>();
+    QCOMPARE(quotes.size(), 32);
+    QCOMPARE(query.results().size(), 32);
+    QCOMPARE(quotes.first().objectId(), query.results().first().objectId());
+
+    // dropped data is serialized again from the document on each call, and not kept
+    QVERIFY(!pFindReply->isDataRetained());
+    QCOMPARE(QJsonDocument::fromJson(pFindReply->data()), document);
+    QVERIFY(pFindReply->constData().isEmpty());
+}
+
+void ParseTest::testQueryStreamedFind()
+{
+    auto query = ParseQuery<TestQuote>();
+    query.setStreamingEnabled(true);
+
+    QList<ParseObject> streamed;
+    ParseReply *pFindReply = query.find();
+    connect(pFindReply, &ParseReply::resultsAvailable, this, [&streamed](const QList<ParseObject>& objects)
+    {
+        streamed.append(objects);
+    });
+
+    QSignalSpy findSpy(pFindReply, &ParseReply::finished);
+    QVERIFY(findSpy.wait(SPY_WAIT));
+    pFindReply->deleteLater();
+
+    // results arrive through resultsAvailable, the reply keeps the rest of the response
+    QVERIFY(!pFindReply->isError());
+    QCOMPARE(streamed.size(), 32);
+    QCOMPARE(streamed.first().className(), QString("TestQuote"));
+    QVERIFY(query.results().isEmpty());
+    QVERIFY(pFindReply->document().object().value("results").toArray().isEmpty());
+}
+
+void ParseTest::testQueryDecodeThread()
+{
+    // decode every reply on the thread pool
+    int threshold = ParseClient::get()->decodeThreadThreshold();
+    ParseClient::get()->setDecodeThreadThreshold(0);
+
+    auto query = ParseQuery<TestQuote>();
+    ParseReply *pFindReply = query.find();
+    QSignalSpy findSpy(pFindReply, &ParseReply::finished);
+    QVERIFY(findSpy.wait(SPY_WAIT));
+    pFindReply->deleteLater();
+
+    QVERIFY(!pFindReply->isError());
+    QCOMPARE(query.results().size(), 32);
+    QCOMPARE(pFindReply->objects<TestQuote>().size(), 32);
+
+    ParseReply *pGetReply = ParseQuery<TestQuote>().get(query.results().first().objectId());
+    QSignalSpy getSpy(pGetReply, &ParseReply::finished);
+    QVERIFY(getSpy.wait(SPY_WAIT));
+    pGetReply->deleteLater();
+    QVERIFY(!pGetReply->isError());
+
+    ParseClient::get()->setDecodeThreadThreshold(threshold);
+}
+
+void ParseTest::testQueryResultTable()
+{
+    QJsonArray results = QJsonDocument::fromJson(R"([
+        { "objectId": "a", "rank": 1, "ratio": 0.5, "active": true, "createdAt": "2017-01-02T03:04:05.006Z",
+          "movie": { "__type": "Pointer", "className": "TestMovie", "objectId": "movie1" },
+          "location": { "__type": "GeoPoint", "latitude": 40.0, "longitude": -30.0 } },
+        { "objectId": "b", "rank": 2, "ratio": 2, "tags": ["x"], "mixed": "one" },
+        { "objectId": "c", "rank": null, "ratio": 1.25, "active": false, "mixed": 2 }
+    ])").array();
+
+    ParseResultTable table(results);
+    QCOMPARE(table.rowCount(), 3);
+    QCOMPARE(table.keys(), QStringList({ "active", "createdAt", "location", "mixed", "movie", "objectId", "rank", "ratio", "tags" }));
+
+    // typed columns keep a row for every result, null rows are marked in the bitmap
+    QCOMPARE(table.columnType("rank"), ParseResultTable::IntegerColumn);
+    QCOMPARE(table.integers("rank"), QList<qint64>({ 1, 2, 0 }));
+    QVERIFY(table.isNull("rank", 2));
+    QVERIFY(!table.isNull("rank", 0));
+
+    QCOMPARE(table.columnType("ratio"), ParseResultTable::DoubleColumn);
+    QCOMPARE(table.doubles("ratio"), QList<double>({ 0.5, 2.0, 1.25 }));
+
+    QCOMPARE(table.columnType("active"), ParseResultTable::BoolColumn);
+    QCOMPARE(table.integers("active"), QList<qint64>({ 1, 0, 0 }));
+    QCOMPARE(table.nulls("active"), QBitArray::fromBits("\x02", 3));
+
+    QCOMPARE(table.columnType("createdAt"), ParseResultTable::DateColumn);
+    QCOMPARE(table.integers("createdAt").first(), QDateTime::fromString("2017-01-02T03:04:05.006Z", Qt::ISODateWithMs).toMSecsSinceEpoch());
+
+    QCOMPARE(table.columnType("movie"), ParseResultTable::PointerColumn);
+    QCOMPARE(table.strings("movie"), QStringList({ "movie1", "", "" }));
+    QCOMPARE(table.columnType("location"), ParseResultTable::GeoPointColumn);
+    QCOMPARE(table.doubles("location").mid(0, 2), QList<double>({ 40.0, -30.0 }));
+    QCOMPARE(table.doubles("location").size(), 6);
+
+    QCOMPARE(table.columnType("objectId"), ParseResultTable::StringColumn);
+    QCOMPARE(table.columnType("mixed"), ParseResultTable::VariantColumn);
+    QCOMPARE(table.variants("mixed").at(2).toInt(), 2);
+    QCOMPARE(table.columnType("tags"), ParseResultTable::VariantColumn);
+    QCOMPARE(table.columnType("missing"), ParseResultTable::NullColumn);
+
+    // a reply builds the table from its results
+    auto query = ParseQuery<TestQuote>();
+    ParseReply *pFindReply = query.find();
+    QSignalSpy findSpy(pFindReply, &ParseReply::finished);
+    QVERIFY(findSpy.wait(SPY_WAIT));
+    pFindReply->deleteLater();
+
+    ParseResultTable quotes = pFindReply->table({ "rank", "movie" });
+    QCOMPARE(quotes.rowCount(), 32);
+    QCOMPARE(quotes.columnType("rank"), ParseResultTable::IntegerColumn);
+    QCOMPARE(quotes.columnType("movie"), ParseResultTable::PointerColumn);
+    QCOMPARE(quotes.strings("movie").first(), query.results().first().value("movie").value<ParseObject>().objectId());
+}
+
 void ParseTest::testQueryOrder()
 {
     auto pAscendingQuery = ParseQuery<TestQuote>();
@@ -1304,3 +2195,156 @@ void ParseTest::testAnalytics()
     QVERIFY(!reply3->isError());
 }
 
+void ParseTest::testRequestRetry()
+{
+    ParseRetryPolicy policy;
+    policy.maxAttempts = 3;
+    policy.initialDelay = 10;
+    ParseClient::get()->setRetryPolicy(policy);
+
+    // new requests start with the policy of the client
+    ParseRequest request(ParseRequest::PostHttpMethod, "http://127.0.0.1:1/parse/classes/TestQuote", "{}");
+    QCOMPARE(request.retryPolicy().maxAttempts, 3);
+
+    // a refused connection is retried until the attempts run out, then finishes without a status like before
+    int retried = ParseClient::get()->retriedRequestCount();
+    ParseReply *pReply = new ParseReply(request, nullptr);
+    QSignalSpy spy(pReply, &ParseReply::finished);
+    QVERIFY(spy.wait(SPY_WAIT));
+    QCOMPARE(pReply->statusCode(), 0);
+    QCOMPARE(ParseClient::get()->retriedRequestCount(), retried + 2);
+    pReply->deleteLater();
+
+    // a single attempt is never retried
+    ParseRetryPolicy singlePolicy;
+    request.setRetryPolicy(singlePolicy);
+    retried = ParseClient::get()->retriedRequestCount();
+    ParseReply *pSingleReply = new ParseReply(request, nullptr);
+    QSignalSpy singleSpy(pSingleReply, &ParseReply::finished);
+    QVERIFY(singleSpy.wait(SPY_WAIT));
+    QCOMPARE(pSingleReply->statusCode(), 0);
+    QCOMPARE(ParseClient::get()->retriedRequestCount(), retried);
+    pSingleReply->deleteLater();
+
+    // requests that succeed are not affected
+    auto query = ParseQuery<TestCharacter>();
+    ParseReply *pFindReply = query.find();
+    QSignalSpy findSpy(pFindReply, &ParseReply::finished);
+    QVERIFY(findSpy.wait(SPY_WAIT));
+    QVERIFY(!pFindReply->isError());
+    QCOMPARE(query.results().size(), 20);
+    pFindReply->deleteLater();
+
+    ParseClient::get()->setRetryPolicy(ParseRetryPolicy());
+}
+
+void ParseTest::testRequestAbort()
+{
+    // an aborted reply finishes right away and never again
+    auto query = ParseQuery<TestCharacter>();
+    ParseReply *pFindReply = query.find();
+    QSignalSpy findSpy(pFindReply, &ParseReply::finished);
+    pFindReply->abort();
+    QCOMPARE(findSpy.count(), 1);
+    QCOMPARE(pFindReply->errorCode(), int(ParseError::RequestAborted));
+    QVERIFY(query.results().isEmpty());
+
+    QTest::qWait(500);
+    QCOMPARE(findSpy.count(), 1);
+    pFindReply->deleteLater();
+
+    // aborting or deleting a reply cancels its request, a waiting one never starts
+    ParseClient::get()->setMaxRequestsPerHost(1);
+
+    QList<ParseReply*> replies;
+    for (int i = 0; i < 3; i++)
+    {
+        auto skipQuery = ParseQuery<TestCharacter>();
+        skipQuery.setSkip(i);
+        replies.append(skipQuery.find());
+    }
+
+    QCOMPARE(ParseClient::get()->queuedRequestCount(), 2);
+    replies.at(1)->abort();
+    QCOMPARE(ParseClient::get()->queuedRequestCount(), 1);
+    delete replies.at(2);
+    QCOMPARE(ParseClient::get()->queuedRequestCount(), 0);
+
+    QSignalSpy firstSpy(replies.first(), &ParseReply::finished);
+    QVERIFY(firstSpy.wait(SPY_WAIT));
+    QVERIFY(!replies.first()->isError());
+    replies.first()->deleteLater();
+    replies.at(1)->deleteLater();
+
+    ParseClient::get()->setMaxRequestsPerHost(6);
+
+    // a reply that is not finished by its deadline times out
+    ParseReply *pDeadlineReply = query.find();
+    pDeadlineReply->setDeadline(QDeadlineTimer(1));
+    QSignalSpy deadlineSpy(pDeadlineReply, &ParseReply::finished);
+    QVERIFY(deadlineSpy.wait(SPY_WAIT));
+    QVERIFY(pDeadlineReply->isAborted());
+    QCOMPARE(pDeadlineReply->errorCode(), int(ParseError::RequestTimeout));
+    pDeadlineReply->deleteLater();
+
+    // one with time to spare is not affected
+    ParseReply *pTimelyReply = query.find();
+    pTimelyReply->setDeadline(QDeadlineTimer(SPY_WAIT));
+    QSignalSpy timelySpy(pTimelyReply, &ParseReply::finished);
+    QVERIFY(timelySpy.wait(SPY_WAIT));
+    QVERIFY(!pTimelyReply->isError());
+    QCOMPARE(query.results().size(), 20);
+    pTimelyReply->deleteLater();
+}
+
+void ParseTest::testRequestHedge()
+{
+    auto query = ParseQuery<TestCharacter>();
+    ParseReply *pFindReply = query.find();
+    QSignalSpy findSpy(pFindReply, &ParseReply::finished);
+    QVERIFY(findSpy.wait(SPY_WAIT));
+    pFindReply->deleteLater();
+    QString id = query.first().objectId();
+
+    // a duplicate is sent for any GET slower than the fastest recent one, as far as the budget allows
+    ParseHedgePolicy policy;
+    policy.enabled = true;
+    policy.percentile = 0;
+    policy.budgetPercent = 0;
+    ParseClient::get()->setHedgePolicy(policy);
+
+    int hedged = ParseClient::get()->hedgedRequestCount();
+    for (int i = 0; i < 25; i++)
+    {
+        ParseReply *pGetReply = query.get(id);
+        QSignalSpy getSpy(pGetReply, &ParseReply::finished);
+        QVERIFY(getSpy.wait(SPY_WAIT));
+        QCOMPARE(pGetReply->first<TestCharacter>().objectId(), id);
+        pGetReply->deleteLater();
+    }
+
+    QCOMPARE(ParseClient::get()->hedgedRequestCount(), hedged);
+
+    // a find with includes is slower than the fastest get, so it is hedged,
+    // whichever reply answers first the results are the same
+    policy.budgetPercent = 100;
+    ParseClient::get()->setHedgePolicy(policy);
+
+    for (int i = 0; i < 10 && ParseClient::get()->hedgedRequestCount() == hedged; i++)
+    {
+        auto quoteQuery = ParseQuery<TestQuote>();
+        quoteQuery.include("movie");
+        quoteQuery.include("character");
+        ParseReply *pQuoteReply = quoteQuery.find();
+        QSignalSpy quoteSpy(pQuoteReply, &ParseReply::finished);
+        QVERIFY(quoteSpy.wait(SPY_WAIT));
+        QVERIFY(!pQuoteReply->isError());
+        QCOMPARE(quoteQuery.results().size(), 32);
+        QVERIFY(!quoteQuery.first().character().name().isEmpty());
+        pQuoteReply->deleteLater();
+    }
+
+    QVERIFY(ParseClient::get()->hedgedRequestCount() > hedged);
+
+    ParseClient::get()->setHedgePolicy(ParseHedgePolicy());
+}
@@ -19,6 +19,7 @@
 
 #include "parseobject.h"
 #include "parsefile.h"
+#include "parsefield.h"
 #include <QObject>
 #include <QDir>
 
@@ -99,6 +100,26 @@ private:
 
 Q_DECLARE_METATYPE(TestQuote);
 
+//
+// TestQuoteRecord
+//
+struct TestQuoteRecord
+{
+    QString objectId;
+    int rank = 0;
+    QString quote;
+    TestMovie movie;
+    QDateTime createdAt;
+
+    static constexpr const char *className = "TestQuote";
+    static constexpr auto fields = std::make_tuple(
+        cg::parseField("objectId", &TestQuoteRecord::objectId),
+        cg::parseField("rank", &TestQuoteRecord::rank),
+        cg::parseField("quote", &TestQuoteRecord::quote),
+        cg::parseField("movie", &TestQuoteRecord::movie),
+        cg::parseField("createdAt", &TestQuoteRecord::createdAt));
+};
+
 //
 // TestNamespace
 //
@@ -134,6 +155,9 @@ private slots:
     void cleanupTestCase();
 
     void testVariant();
+    void testConvert();
+    void testConvertBenchmark_data();
+    void testConvertBenchmark();
     void testDateTime();
     void testGeoPoint();
     void testPolygon();
@@ -144,16 +168,34 @@ private slots:
 
     void testObject();
     void testObjectRevert();
+    void testObjectDirtyKeys();
+    void testObjectKeys();
+    void testObjectRecord();
     void testObjectArray();
     void testObjectRelation();
     void testObjectPointerHash();
     void testObjectReferenceSave();
+    void testObjectGraphSave();
     void testObjectSetObject();
+    void testObjectCoalescing();
+    void testObjectSaveAllChunks();
+    void testObjectSaveAllAbort();
 
     void testQueryNamespace();
     void testQueryGet();
     void testQueryFindAll();
     void testQueryCount();
+    void testQueryStream();
+    void testQueryScan();
+    void testQueryCache();
+    void testQueryIdentityMap();
+    void testQuerySharedRequest();
+    void testQueryPriority();
+    void testQueryAdaptiveConcurrency();
+    void testQueryReplyDocument();
+    void testQueryStreamedFind();
+    void testQueryDecodeThread();
+    void testQueryResultTable();
     void testQueryOrder();
     void testQueryComparison();
     void testQueryFullText();
@@ -174,6 +216,10 @@ private slots:
     void testGraphQL();
     void testAnalytics();
 
+    void testRequestRetry();
+    void testRequestAbort();
+    void testRequestHedge();
+
 private:
     TestMovie episode1, episode2, episode3, episode4, episode5, episode6, episode7, episode8, rogue1;
     TestCharacter leia, han, obiwan, yoda, luke, palpatine, anakin, vader, quigon, nute, 